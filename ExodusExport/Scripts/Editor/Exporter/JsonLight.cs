@@ -12,6 +12,7 @@ namespace SceneExport{
 		public float shadowStrength = 0.0f;
 		public float intensity = 0.0f;
 		public string renderMode;
+		public string lightmapBakeType;
 		public string shadows;
 		public float bounceIntensity = 0.0f;
 			
@@ -20,6 +21,7 @@ namespace SceneExport{
 			writer.writeKeyVal("bounceIntensity", bounceIntensity);
 			writer.writeKeyVal("color", color);
 			writer.writeKeyVal("intensity", intensity);
+			writer.writeKeyVal("lightmapBakeType", lightmapBakeType);
 			writer.writeKeyVal("range", range);
 			writer.writeKeyVal("renderMode", renderMode);
 			writer.writeKeyVal("shadows", shadows);
@@ -42,6 +44,7 @@ namespace SceneExport{
 			spotAngle = l.spotAngle;
 			type = l.type.ToString();
 			renderMode = l.renderMode.ToString();
+			lightmapBakeType = l.lightmapBakeType.ToString();
 			shadowStrength = l.shadowStrength;
 			shadows = l.shadows.ToString();
 			intensity = l.intensity;
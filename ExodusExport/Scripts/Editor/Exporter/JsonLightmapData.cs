@@ -0,0 +1,41 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+namespace SceneExport{
+	/*
+	One entry of LightmapSettings.lightmaps. Renderer lightmapIndex refers to these.
+	*/
+	[System.Serializable]
+	public class JsonLightmapData: IFastJsonValue{
+		public ResId lightmapColor = ResId.invalid;
+		public ResId lightmapDir = ResId.invalid;
+		public ResId shadowMask = ResId.invalid;
+
+		public void writeRawJsonValue(FastJsonWriter writer){
+			writer.beginRawObject();
+			writer.writeKeyVal("lightmapColor", lightmapColor);
+			writer.writeKeyVal("lightmapDir", lightmapDir);
+			writer.writeKeyVal("shadowMask", shadowMask);
+			writer.endObject();
+		}
+
+		public static List<JsonLightmapData> makeLightmapList(ResourceMapper resMap){
+			var result = new List<JsonLightmapData>();
+			var lightmaps = LightmapSettings.lightmaps;
+			if (lightmaps == null)
+				return result;
+			foreach(var cur in lightmaps){
+				result.Add(new JsonLightmapData(cur, resMap));
+			}
+			return result;
+		}
+
+		public JsonLightmapData(LightmapData data, ResourceMapper resMap){
+			if (data == null)
+				return;
+			lightmapColor = resMap.getTextureId(data.lightmapColor);
+			lightmapDir = resMap.getTextureId(data.lightmapDir);
+			shadowMask = resMap.getTextureId(data.shadowMask);
+		}
+	}
+}
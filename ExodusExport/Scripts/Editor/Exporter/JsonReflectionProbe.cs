@@ -23,6 +23,7 @@ namespace SceneExport{
 		//well, that's cute. customBakedTexture on reflection probe is Texture, despite being limited to cubemap in editor
 		public ResId customCubemapId = ResId.invalid;
 		public ResId customTex2dId = ResId.invalid;
+		public ResId bakedCubemapId = ResId.invalid;
 		//public string timeSlicingMode;
 		
 		public void writeRawJsonValue(FastJsonWriter writer){
@@ -44,6 +45,7 @@ namespace SceneExport{
 			
 			writer.writeKeyVal("customCubemapId", customCubemapId);
 			writer.writeKeyVal("customTex2dId", customTex2dId);
+			writer.writeKeyVal("bakedCubemapId", bakedCubemapId);
 			//writer.writeKeyVal("timeSlicingMode", timeSlicingMode);
 			writer.endObject();			
 		}
@@ -89,6 +91,7 @@ namespace SceneExport{
 			var customTex2d = obj.customBakedTexture as Texture2D;			
 			customCubemapId = resMap.getCubemapId(customCubemap);
 			customTex2dId = resMap.getTextureId(customTex2d);
+			bakedCubemapId = resMap.getCubemapId(obj.bakedTexture as Cubemap);
 		}
 	}
 }
\ No newline at end of file
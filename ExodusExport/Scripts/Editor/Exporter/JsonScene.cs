@@ -11,6 +11,7 @@ namespace SceneExport{
 		public string path;
 		public int buildIndex = -1;
 		public List<JsonGameObject> objects = new List<JsonGameObject>();
+		public List<JsonLightmapData> lightmaps = new List<JsonLightmapData>();
 		
 		public static JsonScene fromScene(Scene scene, ResourceMapper resMap, bool showGui){
 			var rootObjects = scene.GetRootGameObjects();
@@ -18,6 +19,9 @@ namespace SceneExport{
 			result.name = scene.name;
 			result.path = scene.path;
 			result.buildIndex = scene.buildIndex;
+			//LightmapSettings only describes the active scene, renderer lightmap indexes of other scenes would not match.
+			if (scene == SceneManager.GetActiveScene())
+				result.lightmaps = JsonLightmapData.makeLightmapList(resMap);
 			return result;
 		}
 		
@@ -60,6 +64,7 @@ namespace SceneExport{
 			
 		public void writeJsonObjectFields(FastJsonWriter writer){
 			writer.writeKeyVal("objects", objects);
+			writer.writeKeyVal("lightmaps", lightmaps);
 		}
 			
 		public void writeRawJsonValue(FastJsonWriter writer){
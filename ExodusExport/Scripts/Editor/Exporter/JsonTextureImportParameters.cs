@@ -26,6 +26,7 @@ namespace SceneExport{
 			writer.writeKeyVal("maxTextureSize", importer.maxTextureSize);
 			writer.writeKeyVal("mipmapFadeDistanceEnd", importer.mipmapFadeDistanceEnd);
 			writer.writeKeyVal("mipmapFadeDistanceStart", importer.mipmapFadeDistanceStart);
+			writer.writeKeyVal("mipmapEnabled", importer.mipmapEnabled);
 			writer.writeKeyVal("mipmapFilter", importer.mipmapFilter.ToString());
 			writer.writeKeyVal("mipMapsPreserveCoverage", importer.mipMapsPreserveCoverage);
 			writer.writeKeyVal("heightmapScale", importer.heightmapScale);
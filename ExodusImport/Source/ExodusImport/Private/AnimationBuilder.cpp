@@ -1,19 +1,115 @@
 #include "JsonImportPrivatePCH.h"
 #include "AnimationBuilder.h"
+#include "JsonObjects/JsonBinaryAnimationClip.h"
 #include "Runtime/Engine/Classes/Animation/AnimSequence.h"
 #include "Runtime/Engine/Classes/Animation/Skeleton.h"
 
-void addRawTrackBoneKey(FRawAnimSequenceTrack &outTrack, const JsonTransformKey &key){
-	auto unrealMatrix = key.local.getUnrealTransform();
-	FTransform transform;
-	transform.SetFromMatrix(unrealMatrix);
-
+void addRawTrackBoneKey(FRawAnimSequenceTrack &outTrack, const FTransform &transform){
 	outTrack.PosKeys.Add(transform.GetLocation());
 	outTrack.ScaleKeys.Add(transform.GetScale3D());
 	outTrack.RotKeys.Add(transform.GetRotation());
 }
 
+FTransform getUnrealKeyTransform(const JsonTransform &local){
+	auto unrealMatrix = local.getUnrealTransform();
+	FTransform transform;
+	transform.SetFromMatrix(unrealMatrix);
+	return transform;
+}
+
+/*
+Raw tracks must hold either a single key or one key per frame in every channel, 
+so only constant channels can be reduced: they are collapsed to one key. 
+Moving channels are left to the engine compressor.
+*/
+template<typename T, typename DistFunc> int reduceRawChannel(TArray<T> &keys, float tolerance, DistFunc distFunc){
+	if (keys.Num() <= 1)
+		return keys.Num();
+
+	for(int i = 1; i < keys.Num(); i++){
+		if (distFunc(keys[0], keys[i]) > tolerance)
+			return keys.Num();
+	}
+	keys.SetNum(1);
+	return keys.Num();
+}
+
+void AnimationBuilder::reduceRawTrack(FRawAnimSequenceTrack &track, int &outSrcKeys, int &outDstKeys) const{
+	outSrcKeys = track.PosKeys.Num() + track.RotKeys.Num() + track.ScaleKeys.Num();
+
+	//Keeping consecutive quaternions in the same hemisphere, otherwise interpolation goes the long way around.
+	for(int i = 0; i < track.RotKeys.Num(); i++){
+		auto &cur = track.RotKeys[i];
+		cur.Normalize();
+		if ((i > 0) && ((cur | track.RotKeys[i - 1]) < 0.0f))
+			cur = -cur;
+	}
+
+	if (reduction.quantize){
+		for(auto &cur: track.PosKeys)
+			cur = cur.GridSnap(reduction.positionQuantum);
+		for(auto &cur: track.ScaleKeys)
+			cur = cur.GridSnap(reduction.scaleQuantum);
+	}
+
+	auto vecDist = [](const FVector &a, const FVector &b){
+		return (a - b).GetAbsMax();
+	};
+	auto quatDist = [](const FQuat &a, const FQuat &b){
+		return a.AngularDistance(b);
+	};
+	outDstKeys = reduceRawChannel(track.PosKeys, reduction.positionTolerance, vecDist)
+		+ reduceRawChannel(track.RotKeys, reduction.rotationTolerance, quatDist)
+		+ reduceRawChannel(track.ScaleKeys, reduction.scaleTolerance, vecDist);
+}
+
+void PreparedAnimationClip::prepare(const JsonAnimationClip &srcClip){
+	name = srcClip.name;
+	frameRate = srcClip.frameRate;
+
+	tracks.Empty(srcClip.matrixCurves.Num());
+	for(const auto &matCurve: srcClip.matrixCurves){
+		if (matCurve.keys.Num() <= 0)
+			continue;
+
+		auto &dstTrack = tracks.AddDefaulted_GetRef();
+		dstTrack.objectName = matCurve.objectName;
+		dstTrack.frames.Reserve(matCurve.keys.Num());
+		dstTrack.transforms.Reserve(matCurve.keys.Num());
+		for(const auto &curKey: matCurve.keys){
+			dstTrack.frames.Add(curKey.frame);
+			dstTrack.transforms.Add(getUnrealKeyTransform(curKey.local));
+		}
+	}
+}
+
+void PreparedAnimationClip::prepare(const JsonBinaryAnimationClip &srcClip){
+	name = srcClip.name;
+	frameRate = srcClip.frameRate;
+
+	tracks.Empty(srcClip.curves.Num());
+	for(const auto &srcCurve: srcClip.curves){
+		const auto numKeys = srcCurve.frames.Num();
+		if (numKeys <= 0)
+			continue;
+
+		auto &dstTrack = tracks.AddDefaulted_GetRef();
+		dstTrack.objectName = srcCurve.objectName;
+		dstTrack.frames = srcCurve.frames;
+		dstTrack.transforms.SetNum(numKeys);
+		for(int keyIndex = 0; keyIndex < numKeys; keyIndex++){
+			dstTrack.transforms[keyIndex] = getUnrealKeyTransform(srcClip.getKeyTransform(srcCurve, keyIndex));
+		}
+	}
+}
+
 void AnimationBuilder::buildAnimation(UAnimSequence *animSeq, USkeleton *skel, const JsonAnimationClip &srcClip){
+	PreparedAnimationClip preparedClip;
+	preparedClip.prepare(srcClip);
+	buildAnimation(animSeq, skel, preparedClip);
+}
+
+void AnimationBuilder::buildAnimation(UAnimSequence *animSeq, USkeleton *skel, const PreparedAnimationClip &srcClip){
 	check(animSeq);
 	animSeq->CleanAnimSequenceForImport();
 	if (!skel){
@@ -25,54 +121,67 @@ void AnimationBuilder::buildAnimation(UAnimSequence *animSeq, USkeleton *skel, c
 	int minFrame = 0;
 	int maxFrame = 0;
 
-	for(const auto &matCurve: srcClip.matrixCurves){
-		if (matCurve.keys.Num() <= 0)
+	for(const auto &srcTrack: srcClip.tracks){
+		if (srcTrack.frames.Num() <= 0)
 			continue;
 
-		const auto &firstKey = matCurve.keys[0];
-		const auto &lastKey = matCurve.keys[matCurve.keys.Num() - 1];
-		minFrame = FMath::Min(minFrame, firstKey.frame);
-		maxFrame = FMath::Max(maxFrame, lastKey.frame);
+		minFrame = FMath::Min(minFrame, srcTrack.frames[0]);
+		maxFrame = FMath::Max(maxFrame, srcTrack.frames.Last());
 	}
 
 	UE_LOG(JsonLog, Log,  TEXT(""));
 
 	int numFrames = maxFrame - minFrame + 1;
+	int totalSrcKeys = 0;
+	int totalDstKeys = 0;
 
-	for(const auto &matCurve: srcClip.matrixCurves){
-		if (matCurve.keys.Num() <= 0)
+	for(const auto &srcTrack: srcClip.tracks){
+		if (srcTrack.frames.Num() <= 0)
 			continue;
+		check(srcTrack.frames.Num() == srcTrack.transforms.Num());
 
 		FRawAnimSequenceTrack rawAnimTrack;
+		rawAnimTrack.PosKeys.Reserve(numFrames);
+		rawAnimTrack.RotKeys.Reserve(numFrames);
+		rawAnimTrack.ScaleKeys.Reserve(numFrames);
+
+		const auto &keyFrames = srcTrack.frames;
+		const auto &keyTransforms = srcTrack.transforms;
 
-		const auto &firstKey = matCurve.keys[0];
-		const auto &lastKey = matCurve.keys[matCurve.keys.Num() - 1];
-		int lastFrame = -1;
-		
 		int frameIndex = 0;
-		while(frameIndex < firstKey.frame){
-			addRawTrackBoneKey(rawAnimTrack, firstKey);
+		while(frameIndex < keyFrames[0]){
+			addRawTrackBoneKey(rawAnimTrack, keyTransforms[0]);
 			frameIndex++;
 		}
 
-		auto lastWrittenKey = firstKey;
-		for(int i = 0; i < matCurve.keys.Num(); i++){
-			const auto &curKey = matCurve.keys[i];
-			while(frameIndex < curKey.frame){
-				addRawTrackBoneKey(rawAnimTrack, lastWrittenKey);
+		int lastWrittenKey = 0;
+		for(int i = 0; i < keyFrames.Num(); i++){
+			while(frameIndex < keyFrames[i]){
+				addRawTrackBoneKey(rawAnimTrack, keyTransforms[lastWrittenKey]);
 				frameIndex++;
 			}
-			lastWrittenKey = curKey;
-			addRawTrackBoneKey(rawAnimTrack, curKey);
+			lastWrittenKey = i;
+			addRawTrackBoneKey(rawAnimTrack, keyTransforms[i]);
 			frameIndex++;
 		}
 
 		while(frameIndex <= maxFrame){
-			addRawTrackBoneKey(rawAnimTrack, lastKey);
+			addRawTrackBoneKey(rawAnimTrack, keyTransforms.Last());
 			frameIndex++;
 		}
 
-		animSeq->AddNewRawTrack(*matCurve.objectName, &rawAnimTrack);
+		if (reduction.enabled){
+			int srcKeys = 0, dstKeys = 0;
+			reduceRawTrack(rawAnimTrack, srcKeys, dstKeys);
+			totalSrcKeys += srcKeys;
+			totalDstKeys += dstKeys;
+		}
+
+		animSeq->AddNewRawTrack(*srcTrack.objectName, &rawAnimTrack);
+	}
+
+	if (reduction.enabled){
+		UE_LOG(JsonLog, Log, TEXT("Key reduction on clip \"%s\": %d keys reduced to %d"), *srcClip.name, totalSrcKeys, totalDstKeys);
 	}
 
 #if (ENGINE_MAJOR_VERSION >= 4) && (ENGINE_MINOR_VERSION >= 22)
@@ -2,7 +2,53 @@
 #include "CoreMinimal.h"
 #include "JsonObjects.h"
 
+struct FRawAnimSequenceTrack;
+class JsonBinaryAnimationClip;
+
+/*
+Error bounds for the key reduction pass that runs on dense raw tracks before they're added to the sequence.
+Distances are in unreal units (cm) for position, radians for rotation, and unitless for scale.
+*/
+struct AnimationReductionSettings{
+	bool enabled = true;
+	bool quantize = false;
+
+	float positionTolerance = 0.01f;
+	float rotationTolerance = 0.0001f;
+	float scaleTolerance = 0.0001f;
+
+	float positionQuantum = 0.001f;
+	float scaleQuantum = 0.0001f;
+};
+
+/*
+Matrix curve decomposed into unreal local transforms, one per source key.
+*/
+struct AnimationTransformTrack{
+	FString objectName;
+	IntArray frames;
+	TArray<FTransform> transforms;
+};
+
+/*
+Decomposition does not depend on the target skeleton, so one prepared clip is shared by every skeleton/controller pair using it.
+Holds no UObjects and can be built on worker threads.
+*/
+struct PreparedAnimationClip{
+	FString name;
+	float frameRate = 0.0f;
+	TArray<AnimationTransformTrack> tracks;
+
+	void prepare(const JsonAnimationClip &srcClip);
+	void prepare(const JsonBinaryAnimationClip &srcClip);
+};
+
 class AnimationBuilder{
 public:
+	AnimationReductionSettings reduction;
+
 	void buildAnimation(UAnimSequence *animSequence, USkeleton *skeleton, const JsonAnimationClip &srcClip);
+	void buildAnimation(UAnimSequence *animSequence, USkeleton *skeleton, const PreparedAnimationClip &srcClip);
+protected:
+	void reduceRawTrack(FRawAnimSequenceTrack &track, int &outSrcKeys, int &outDstKeys) const;
 };
@@ -0,0 +1,123 @@
+#pragma once
+#include "JsonTypes.h"
+#include "Algo/BinarySearch.h"
+
+inline int32 denseIdToIndex(int32 id){
+	return id;
+}
+
+inline int32 denseIdToIndex(const ResId &id){
+	return id.toIndex();
+}
+
+/*
+Id keyed table for ids that the exporter assigns densely starting from zero.
+Small non-negative ids are stored in a flat array addressed by id. Ids that would make the array 
+too sparse (or negative ones) go into a compact sorted array instead.
+
+Mirrors the subset of TMap interface used by the importer. As with TMap, adding entries may invalidate 
+previously returned pointers.
+*/
+template<typename Value, typename Key = int32> class DenseIdMap{
+protected:
+	using SparseEntry = TPair<int32, Value>;
+
+	TArray<Value> denseValues;
+	TBitArray<> denseUsed;
+	TArray<SparseEntry> sparseValues;//sorted by id
+	int32 numEntries = 0;
+
+	bool fitsDense(int32 index) const{
+		if (index < 0)
+			return false;
+		if (index < denseValues.Num())
+			return true;
+		//Keep at least roughly half of the dense slots in use.
+		return index < FMath::Max(64, (numEntries + 1) * 2);
+	}
+
+	int32 findSparseIndex(int32 index) const{
+		auto pos = Algo::LowerBoundBy(sparseValues, index, [](const SparseEntry &arg){return arg.Key;});
+		if ((pos < sparseValues.Num()) && (sparseValues[pos].Key == index))
+			return pos;
+		return INDEX_NONE;
+	}
+public:
+	int32 Num() const{
+		return numEntries;
+	}
+
+	void Empty(){
+		denseValues.Empty();
+		denseUsed.Empty();
+		sparseValues.Empty();
+		numEntries = 0;
+	}
+
+	const Value* Find(const Key &key) const{
+		auto index = denseIdToIndex(key);
+		if ((index >= 0) && (index < denseValues.Num()))
+			return denseUsed[index] ? &denseValues[index]: nullptr;
+		auto sparseIndex = findSparseIndex(index);
+		return (sparseIndex != INDEX_NONE) ? &sparseValues[sparseIndex].Value: nullptr;
+	}
+
+	Value* Find(const Key &key){
+		return const_cast<Value*>(static_cast<const DenseIdMap*>(this)->Find(key));
+	}
+
+	bool Contains(const Key &key) const{
+		return Find(key) != nullptr;
+	}
+
+	Value& operator[](const Key &key){
+		auto result = Find(key);
+		check(result);
+		return *result;
+	}
+
+	const Value& operator[](const Key &key) const{
+		auto result = Find(key);
+		check(result);
+		return *result;
+	}
+
+	Value& Add(const Key &key, const Value &value){
+		auto index = denseIdToIndex(key);
+		if (fitsDense(index)){
+			if (index >= denseValues.Num()){
+				auto newSize = FMath::Max(index + 1, denseValues.Num() * 2);
+				denseValues.SetNum(newSize);
+				denseUsed.Add(false, newSize - denseUsed.Num());
+				//Sparse entries now covered by the dense range have to move, or lookups would miss them.
+				for(int32 i = sparseValues.Num() - 1; i >= 0; i--){
+					auto sparseId = sparseValues[i].Key;
+					if ((sparseId < 0) || (sparseId >= newSize))
+						continue;
+					denseValues[sparseId] = MoveTemp(sparseValues[i].Value);
+					denseUsed[sparseId] = true;
+					sparseValues.RemoveAt(i, 1, false);
+				}
+			}
+			if (!denseUsed[index]){
+				denseUsed[index] = true;
+				numEntries++;
+			}
+			denseValues[index] = value;
+			return denseValues[index];
+		}
+
+		auto pos = Algo::LowerBoundBy(sparseValues, index, [](const SparseEntry &arg){return arg.Key;});
+		if ((pos < sparseValues.Num()) && (sparseValues[pos].Key == index)){
+			sparseValues[pos].Value = value;
+			return sparseValues[pos].Value;
+		}
+		numEntries++;
+		sparseValues.Insert(SparseEntry(index, value), pos);
+		return sparseValues[pos].Value;
+	}
+};
+
+//Asset package paths, interned as names.
+using IdPathMap = DenseIdMap<FName>;
+using ResIdPathMap = DenseIdMap<FName, ResId>;
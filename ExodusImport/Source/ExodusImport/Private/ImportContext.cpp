@@ -5,11 +5,12 @@
 #include "JsonObjects/utilities.h"
 #include "GameFramework/Actor.h"
 #include "Engine/World.h"
+#include "Engine/Engine.h"
 #include "UnrealUtilities.h"
 
 
 void ImportContext::registerDelayedAnimController(JsonId skelId, JsonId controllerId){
-	delayedAnimControllers.Add(AnimControllerIdKey(skelId, controllerId));
+	delayedAnimControllers.AddUnique(AnimControllerIdKey(skelId, controllerId));
 }
 
 void ImportContext::registerAnimatorForPostProcessing(const JsonGameObject &jsonObj){
@@ -213,10 +214,16 @@ ImportContext::ImportContext(UWorld *world_, bool editorMode_, const JsonScene *
 :srcObjects(nullptr), world(world_), editorMode(editorMode_){
 	check(scene_ != nullptr);
 	srcObjects = &scene_->objects;
+	sceneIndex = &scene_->index;
+	lightmaps = &scene_->lightmaps;
 }
 
 ImportContext::ImportContext(UWorld *world_, bool editorMode_, const TArray<JsonGameObject> *objects_)
 :srcObjects(objects_), world(world_), editorMode(editorMode_){
+	check(srcObjects != nullptr);
+	ownedSceneIndex = MakeShared<JsonSceneIndex>();
+	ownedSceneIndex->build(*srcObjects);
+	sceneIndex = ownedSceneIndex.Get();
 }
 
 
@@ -225,6 +232,58 @@ void ImportContext::clear(){
 	importedObjects.Empty();
 
 	delayedAnimControllers.Empty();
+	deferredComponents.Empty();
+	deferredFolderPaths.Empty();
+}
+
+void ImportContext::setFolderPath(const ImportedObject &object, const FString &folderPath, bool recursive){
+	if (!deferRegistration){
+		object.setFolderPath(folderPath, recursive);
+		return;
+	}
+	if (!object.actor)
+		return;
+	deferredFolderPaths.Add(DeferredFolderPath{object.actor, folderPath, recursive});
+}
+
+void ImportContext::convertToInstanceComponent(const ImportedObject &object){
+	if (!deferRegistration){
+		object.convertToInstanceComponent();
+		return;
+	}
+	if (!object.component)
+		return;
+	auto rootActor = object.component->GetAttachmentRootActor();
+	check(rootActor);
+	object.component->bEditableWhenInherited = true;
+	deferredComponents.Add(object.component);
+}
+
+void ImportContext::flushDeferredRegistration(){
+	if ((deferredComponents.Num() == 0) && (deferredFolderPaths.Num() == 0))
+		return;
+	UE_LOG(JsonLog, Log, TEXT("Registering %d deferred components, applying %d folder paths"),
+		deferredComponents.Num(), deferredFolderPaths.Num());
+
+	for(const auto &cur: deferredComponents){
+		auto comp = cur.Get();
+		if (!comp || comp->IsRegistered())
+			continue;
+		comp->RegisterComponent();
+	}
+
+	for(const auto &cur: deferredFolderPaths){
+		auto actor = cur.actor.Get();
+		if (!actor)
+			continue;
+		ImportedObject(actor).setFolderPath(cur.folderPath, cur.recursive);
+	}
+
+	deferredComponents.Empty();
+	deferredFolderPaths.Empty();
+
+	if (GEngine)
+		GEngine->BroadcastLevelActorListChanged();
 }
 
 uint64 ImportContext::getUniqueUint() const{
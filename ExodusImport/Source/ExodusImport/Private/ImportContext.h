@@ -16,6 +16,8 @@ using AnimClipPathMap = TMap<AnimClipIdKey, FString>;
 using AnimControllerPathMap = TMap<AnimControllerIdKey, FString>;
 
 class USceneComponent;
+class LightAnalysis;
+class ReflectionCapturePlan;
 
 /*
 This one exists mostly to deal with the fact that IDs are unique within SCENE, 
@@ -31,8 +33,32 @@ public:
 	uint64 getUniqueUint() const;
 	//const JsonScene *srcScene = nullptr;
 	const TArray<JsonGameObject> *srcObjects = nullptr;
-
-	IdNameMap objectFolderPaths;
+	//Scene provided index, or ownedSceneIndex when importing a bare object array (prefabs).
+	const JsonSceneIndex *sceneIndex = nullptr;
+	TSharedPtr<JsonSceneIndex> ownedSceneIndex;
+
+	//Baked unity lightmaps of the scene, nullptr for prefabs.
+	const TArray<JsonLightmap> *lightmaps = nullptr;
+	bool hasLightmaps() const{
+		return lightmaps && (lightmaps->Num() > 0);
+	}
+	const JsonLightmap* findLightmap(int32 lightmapIndex) const{
+		if (!lightmaps || !lightmaps->IsValidIndex(lightmapIndex))
+			return nullptr;
+		return &(*lightmaps)[lightmapIndex];
+	}
+
+	//Light budget decisions for the objects being imported, nullptr if analysis is disabled.
+	const LightAnalysis *lightAnalysis = nullptr;
+	//Reflection probe consolidation for the objects being imported, nullptr if disabled.
+	const ReflectionCapturePlan *reflectionCapturePlan = nullptr;
+
+	const JsonSceneIndex& getSceneIndex() const{
+		check(sceneIndex);
+		return *sceneIndex;
+	}
+
+	DenseIdMap<FString> objectFolderPaths;
 
 	ImportedObjectMap importedObjects;
 	TStrongObjectPtr<UWorld> world;
@@ -41,6 +67,23 @@ public:
 	TArray<AnimControllerIdKey> delayedAnimControllers;
 	TArray<JsonId> postProcessAnimatorObjects;
 
+	/*
+	Two phase import. While objects are spawned, component registration and outliner folder assignment
+	are only queued, then flushDeferredRegistration applies them in one pass.
+	*/
+	struct DeferredFolderPath{
+		TWeakObjectPtr<AActor> actor;
+		FString folderPath;
+		bool recursive = false;
+	};
+	bool deferRegistration = false;
+	TArray<TWeakObjectPtr<USceneComponent>> deferredComponents;
+	TArray<DeferredFolderPath> deferredFolderPaths;
+
+	void setFolderPath(const ImportedObject &object, const FString &folderPath, bool recursive = false);
+	void convertToInstanceComponent(const ImportedObject &object);
+	void flushDeferredRegistration();
+
 	UObject* findSuitableOuter(const JsonGameObject &jsonObj) const;
 
 	//void changeOwnerRecursively(USceneComponent *rootComponent, UObject *newOwner) const;
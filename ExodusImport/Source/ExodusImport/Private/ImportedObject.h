@@ -2,6 +2,7 @@
 #include "CoreMinimal.h"
 #include "JsonObjects.h"
 #include "Runtime/CoreUObject/Public/UObject/StrongObjectPtr.h"
+#include "DenseIdMap.h"
 
 /*
 This structure holds "spawned game object" information.
@@ -75,6 +76,6 @@ public:
 		:actor(nullptr), component(component_){}
 };
 
-using ImportedObjectMap = TMap<JsonId, ImportedObject>;
+using ImportedObjectMap = DenseIdMap<ImportedObject>;
 using ImportedObjectArray = TArray<ImportedObject>;
 
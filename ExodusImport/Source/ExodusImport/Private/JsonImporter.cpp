@@ -4,6 +4,10 @@
 #include "UnrealUtilities.h"
 #include "builders/JointBuilder.h"
 #include "builders/PrefabBuilder.h"
+#include "MeshBuilder.h"
+#include "MeshBuilderUtils.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
 
 #include "LocTextNamespace.h"
 
@@ -93,11 +97,14 @@ void JsonImporter::loadSkeletons(const StringArray &skeletons){
 	}
 }
 
-void JsonImporter::loadMaterials(const StringArray &materials){
-	FScopedSlowTask matProgress(materials.Num(), LOCTEXT("Importing materials", "Importing materials"));
-	matProgress.MakeDialog();
-	UE_LOG(JsonLog, Log, TEXT("Processing materials"));
+/*
+Materials are parsed before textures are imported, so texture policy knows how each texture is used,
+and whether it is bound to a base material instance or only to generated material graphs.
+*/
+void JsonImporter::loadJsonMaterials(const StringArray &materials){
+	UE_LOG(JsonLog, Log, TEXT("Loading materials"));
 	jsonMaterials.Empty();
+	texturePolicy.clearUsage();
 	for(auto curFilename: materials){
 		auto obj = loadExternResourceFromFile(curFilename);
 		if (!obj.IsValid())
@@ -105,6 +112,23 @@ void JsonImporter::loadMaterials(const StringArray &materials){
 
 		JsonMaterial jsonMat(obj);
 		jsonMaterials.Add(jsonMat);
+		texturePolicy.gatherUsage(jsonMat, !materialBuilder.usesPackedMaskTemplate(jsonMat, this));
+	}
+}
+
+void JsonImporter::loadMaterials(){
+	FScopedSlowTask matProgress(jsonMaterials.Num(), LOCTEXT("Importing materials", "Importing materials"));
+	matProgress.MakeDialog();
+	UE_LOG(JsonLog, Log, TEXT("Processing materials"));
+
+	staticPermutationPlan.build(jsonMaterials, materialBuilder, this, staticPermutationSettings);
+	UE_LOG(JsonLog, Log, TEXT("Material static permutations: %d in source, %d after folding, %d materials folded"),
+		staticPermutationPlan.getNumSourcePermutations(), staticPermutationPlan.getNumResolvedPermutations(), 
+		staticPermutationPlan.getNumFoldedMaterials());
+	if (jsonMaterials.Num() > 0)
+		saveImportReport(TEXT("Permutations"), staticPermutationPlan.makeReport());
+
+	for(const auto &jsonMat: jsonMaterials){
 		if (!jsonMat.supportedShader){
 			UE_LOG(JsonLog, Warning, TEXT("Material \"%s\"(id: %d) is marked as having unsupported shader \"%s\""),
 				*jsonMat.name, jsonMat.id, *jsonMat.shader);
@@ -113,6 +137,7 @@ void JsonImporter::loadMaterials(const StringArray &materials){
 		auto matInst = materialBuilder.importMaterialInstance(jsonMat, this);
 		if (matInst){
 			registerMaterialInstancePath(jsonMat.id, matInst->GetPathName());
+			materialInstanceCache.registerObject(jsonMat.id, matInst);
 		}
 
 		//importMaterialInstance(jsonMat, curId);
@@ -124,15 +149,63 @@ void JsonImporter::loadMeshes(const StringArray &meshes){
 	FScopedSlowTask meshProgress(meshes.Num(), LOCTEXT("Importing materials", "Importing meshes"));
 	meshProgress.MakeDialog();
 	UE_LOG(JsonLog, Log, TEXT("Processing meshes"));
-	int32 meshId = 0;
-	for(auto curFilename: meshes){
-		auto obj = loadExternResourceFromFile(curFilename);
-		auto curId = meshId;
-		meshId++;//and this one too...
-		if (!obj.IsValid())
-			continue;
-		importMesh(obj, curId);
-		meshProgress.EnterProgressFrame(1.0f);
+
+	/*
+	Meshes are processed in batches. Convex hulls for meshes used by convex colliders and lightmap uv analysis 
+	are computed on worker threads for the whole batch before any UStaticMesh is created.
+	The hulls are cooked in one pass after the batch is built.
+	*/
+	const int32 batchSize = 32;
+	TArray<JsonMesh> batchMeshes;
+	TArray<TArray<FVector>> batchHulls;
+	TArray<MeshBuilderUtils::LightmapUvInfo> batchLightmapUvs;
+	for(int32 batchStart = 0; batchStart < meshes.Num(); batchStart += batchSize){
+		const auto batchNum = FMath::Min(batchSize, meshes.Num() - batchStart);
+		batchMeshes.Reset();
+		batchMeshes.SetNum(batchNum);
+		batchHulls.Reset();
+		batchHulls.SetNum(batchNum);
+		batchLightmapUvs.Reset();
+		batchLightmapUvs.SetNum(batchNum);
+		TBitArray<> loaded(false, batchNum);
+
+		for(int32 i = 0; i < batchNum; i++){
+			auto obj = loadExternResourceFromFile(meshes[batchStart + i]);
+			if (!obj.IsValid())
+				continue;
+			UE_LOG(JsonLog, Log, TEXT("Importing mesh %d"), batchStart + i);
+			batchMeshes[i].load(obj);
+			loaded[i] = true;
+		}
+
+		ParallelFor(batchNum, [&](int32 i){
+			if (!loaded[i])
+				return;
+			if (batchMeshes[i].convexCollider)
+				batchHulls[i] = MeshBuilderUtils::buildConvexHullPoints(batchMeshes[i].verts, MeshBuilderUtils::defaultMaxConvexHullVerts);
+			batchLightmapUvs[i] = MeshBuilderUtils::analyzeLightmapUvs(batchMeshes[i], lightmapUvSettings);
+		});
+
+		for(int32 i = 0; i < batchNum; i++){
+			if (loaded[i]){
+				const auto &jsonMesh = batchMeshes[i];
+				importMesh(jsonMesh, batchStart + i, jsonMesh.convexCollider ? &batchHulls[i]: nullptr, &batchLightmapUvs[i]);
+			}
+			meshProgress.EnterProgressFrame(1.0f);
+		}
+
+		//Convex hulls are cooked once the whole batch is built, rather than inside each mesh setup.
+		TArray<MeshBuilder::ConvexCollisionCook> convexCooks;
+		for(int32 i = 0; i < batchNum; i++){
+			if (!loaded[i] || !batchMeshes[i].convexCollider)
+				continue;
+			if (auto mesh = staticMeshCache.find(batchMeshes[i].id))
+				convexCooks.Add(MeshBuilder::ConvexCollisionCook{mesh, &batchMeshes[i]});
+		}
+		if (convexCooks.Num() > 0){
+			MeshBuilder meshBuilder;
+			meshBuilder.cookConvexCollision(convexCooks);
+		}
 	}
 }
 
@@ -140,6 +213,26 @@ void JsonImporter::loadObjects(const TArray<JsonGameObject> &objects, ImportCont
 	FScopedSlowTask objProgress(objects.Num(), LOCTEXT("Importing objects", "Importing objects"));
 	objProgress.MakeDialog();
 	UE_LOG(JsonLog, Log, TEXT("Import objects"));
+	LightAnalysis lightAnalysis;
+	if (lightAnalysisSettings.enabled){
+		lightAnalysis.build(objects, lightAnalysisSettings, appliesBakedLightmaps(importData));
+		if (!lightAnalysis.isEmpty()){
+			importData.lightAnalysis = &lightAnalysis;
+			saveLightReport(lightAnalysis);
+		}
+	}
+
+	ReflectionCapturePlan reflectionCapturePlan;
+	if (reflectionCaptureSettings.enabled){
+		reflectionCapturePlan.build(objects, reflectionCaptureSettings);
+		if (!reflectionCapturePlan.isEmpty()){
+			importData.reflectionCapturePlan = &reflectionCapturePlan;
+			reflectionCapturePlan.logSummary();
+		}
+	}
+
+	//Registration and folders are applied in one pass after every object has been spawned.
+	importData.deferRegistration = deferObjectRegistration;
 	//int32 objId = 0;
 	for(const auto &curObj: objects){
 		//auto curId = objId;
@@ -147,18 +240,68 @@ void JsonImporter::loadObjects(const TArray<JsonGameObject> &objects, ImportCont
 		importObject(curObj, importData);
 		objProgress.EnterProgressFrame(1.0f);
 	}
+	importData.flushDeferredRegistration();
+	importData.deferRegistration = false;
+	importData.lightAnalysis = nullptr;
+	importData.reflectionCapturePlan = nullptr;
 
 	JointBuilder jointBuilder;
 	jointBuilder.processPhysicsJoints(objects, importData);
 	processDelayedAnimators(objects, importData);
 }
 
+/*
+Unity lightmaps are only applied with custom primitive data, see GeometryComponentBuilder::applyBakedLightmap.
+*/
+bool JsonImporter::appliesBakedLightmaps(const ImportContext &workData) const{
+#ifdef EXODUS_UE_VER_4_26_GE
+	return importBakedLightmaps && workData.hasLightmaps();
+#else
+	return false;
+#endif
+}
+
+void JsonImporter::saveLightReport(const LightAnalysis &lightAnalysis) const{
+	int32 numExcessive = 0, numDisabled = 0, numSkipped = 0;
+	for(const auto &cur: lightAnalysis.getLights()){
+		if (cur.excessiveOverlap)
+			numExcessive++;
+		if (cur.sourceShadows && !cur.castShadows && !cur.skipped)
+			numDisabled++;
+		if (cur.skipped)
+			numSkipped++;
+	}
+	if (numSkipped > 0){
+		UE_LOG(JsonLog, Log, TEXT("%d baked lights are skipped, their lighting comes from the imported unity lightmaps"), numSkipped);
+	}
+	if (numExcessive > 0){
+		UE_LOG(JsonLog, Warning, TEXT("%d shadowed lights overlap with %d or more other shadowed lights"), 
+			numExcessive, lightAnalysisSettings.maxShadowedOverlap);
+	}
+	UE_LOG(JsonLog, Log, TEXT("Light analysis: %d lights, shadows disabled on %d"), lightAnalysis.getLights().Num(), numDisabled);
+
+	saveImportReport(TEXT("Lights"), lightAnalysis.makeReport());
+}
+
+void JsonImporter::saveImportReport(const TCHAR *reportType, const FString &report) const{
+	check(reportType);
+	auto reportName = FString::Printf(TEXT("ExodusImport_%s_%s_%s.txt"), *sourceBaseName, reportType, *FDateTime::Now().ToString());
+	auto reportPath = FPaths::Combine(FPaths::ProjectLogDir(), reportName);
+	if (FFileHelper::SaveStringToFile(report, *reportPath)){
+		UE_LOG(JsonLog, Log, TEXT("%s report saved to \"%s\""), reportType, *reportPath);
+	}
+	else{
+		UE_LOG(JsonLog, Warning, TEXT("Could not save %s report to \"%s\""), reportType, *reportPath);
+	}
+}
+
 void JsonImporter::importResources(const JsonExternResourceList &externRes){
 	assetCommonPath = findCommonPath(externRes.resources);
 
+	loadJsonMaterials(externRes.materials);
 	loadTextures(externRes.textures);
 	loadCubemaps(externRes.cubemaps);
-	loadMaterials(externRes.materials);
+	loadMaterials();
 	loadSkeletons(externRes.skeletons);
 	loadMeshes(externRes.meshes);
 	importPrefabs(externRes.prefabs);
@@ -184,7 +327,7 @@ void JsonImporter::registerMasterMaterialPath(int32 id, FString path){
 	if (matMasterIdMap.Contains(id)){
 		UE_LOG(JsonLog, Warning, TEXT("DUplicate material registration for id %d, path \"%s\""), id, *path);
 	}
-	matMasterIdMap.Add(id, path);
+	matMasterIdMap.Add(id, FName(*path));
 }
 
 void JsonImporter::registerEmissiveMaterial(int32 id){
@@ -194,23 +337,24 @@ void JsonImporter::registerEmissiveMaterial(int32 id){
 FString JsonImporter::getMeshPath(ResId id) const{
 	auto result = meshIdMap.Find(id);
 	if (result)
-		return *result;
+		return result->ToString();
 	return FString();
 }
 
 UStaticMesh* JsonImporter::loadStaticMeshById(ResId id) const{
-	auto path = meshIdMap.Find(id);
-	if (!path)
-		return nullptr;
-	auto result = LoadObject<UStaticMesh>(0, **path);
-	return result;
+	return staticMeshCache.findOrLoad(id, [&]() -> UStaticMesh*{
+		auto path = meshIdMap.Find(id);
+		if (!path)
+			return nullptr;
+		return LoadObject<UStaticMesh>(0, *path->ToString());
+	});
 }
 
 void JsonImporter::registerMaterialInstancePath(int32 id, FString path){
 	if (matInstIdMap.Contains(id)){
 		UE_LOG(JsonLog, Warning, TEXT("Duplicate material registration for id %d, path \"%s\""), id, *path);
 	}
-	matInstIdMap.Add(id, path);
+	matInstIdMap.Add(id, FName(*path));
 }
 
 UMaterialInterface* JsonImporter::loadMaterialInterface(int32 id) const{
@@ -219,11 +363,12 @@ UMaterialInterface* JsonImporter::loadMaterialInterface(int32 id) const{
 
 
 USkeleton* JsonImporter::getSkeletonObject(int32 id) const{
-	auto found = skeletonIdMap.Find(id);
-	if (!found)
-		return nullptr;
-	auto result = LoadObject<USkeleton>(nullptr, **found);
-	return result;
+	return skeletonCache.findOrLoad(id, [&]() -> USkeleton*{
+		auto found = skeletonIdMap.Find(id);
+		if (!found)
+			return nullptr;
+		return LoadObject<USkeleton>(nullptr, *found->ToString());
+	});
 }
 
 void JsonImporter::registerSkeleton(int32 id, USkeleton *skel){
@@ -236,15 +381,18 @@ void JsonImporter::registerSkeleton(int32 id, USkeleton *skel){
 	}
 
 	auto path = skel->GetPathName();
-	skeletonIdMap.Add(id, path);
+	skeletonIdMap.Add(id, FName(*path));
+	skeletonCache.registerObject(id, skel);
 	//auto outer = skel->
 }
 
 UAnimSequence* JsonImporter::getAnimSequence(AnimClipIdKey key) const{
-	auto found = animClipPaths.Find(key);
-	if (!found)
-		return nullptr;
-	return LoadObject<UAnimSequence>(nullptr, **found);
+	return animSequenceCache.findOrLoad(key, [&]() -> UAnimSequence*{
+		auto found = animClipPaths.Find(key);
+		if (!found)
+			return nullptr;
+		return LoadObject<UAnimSequence>(nullptr, **found);
+	});
 }
 
 void JsonImporter::registerAnimSequence(AnimClipIdKey key, UAnimSequence *sequence){
@@ -255,9 +403,10 @@ void JsonImporter::registerAnimSequence(AnimClipIdKey key, UAnimSequence *sequen
 	}
 	auto path = sequence->GetPathName();
 	animClipPaths.Add(key, path);
+	animSequenceCache.registerObject(key, sequence);
 }
 
-const FString* JsonImporter::findMeshPath(ResId meshId) const{
+const FName* JsonImporter::findMeshPath(ResId meshId) const{
 	return meshIdMap.Find(meshId);
 }
 
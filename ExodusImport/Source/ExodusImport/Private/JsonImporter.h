@@ -10,11 +10,18 @@
 #include "JsonObjects/JsonMaterial.h"
 #include "JsonObjects.h"
 #include "ImportContext.h"
+#include "AnimationBuilder.h"
+#include "ResolvedObjectCache.h"
+#include "MeshBuilderUtils.h"
+#include "builders/LightAnalysis.h"
+#include "builders/ReflectionProbeBuilder.h"
+#include "TextureImportPolicy.h"
 #include "ObjectTools.h"
 #include "Editor/UnrealEd/Public/PackageTools.h"
 
 class USkeletalMesh;
 class UTexture;
+class UTexture2D;
 class UTextureCube;
 class USkeleton;
 class UAnimSequence;
@@ -25,32 +32,81 @@ protected:
 	FString sourceExternDataPath;
 	FString assetCommonPath;
 	FString sourceBaseName;
-	ResIdNameMap meshIdMap;
-	ResIdNameMap skinMeshIdMap;
-	IdNameMap texIdMap;
-	IdNameMap cubeIdMap;
-	IdNameMap matMasterIdMap;
-	IdNameMap matInstIdMap;
+	ResIdPathMap meshIdMap;
+	ResIdPathMap skinMeshIdMap;
+	IdPathMap texIdMap;
+	IdPathMap cubeIdMap;
+	IdPathMap matMasterIdMap;
+	IdPathMap matInstIdMap;
 	JsonExternResourceList externResources;
 
 	TArray<JsonMaterial> jsonMaterials;
 	TMap<JsonId, JsonSkeleton> jsonSkeletons;
-	IdNameMap skeletonIdMap;
+	IdPathMap skeletonIdMap;
 
 	AnimClipPathMap animClipPaths;//UAnimationSequence
 
+	/*
+	Objects already resolved from the path maps above. Lookups check these first and only call LoadObject on a miss.
+	*/
+	mutable ResolvedObjectCache<ResId, UStaticMesh> staticMeshCache;
+	mutable ResolvedObjectCache<ResId, USkeletalMesh> skeletalMeshCache;
+	mutable ResolvedObjectCache<JsonId, UTexture> textureCache;
+	mutable ResolvedObjectCache<JsonId, UTextureCube> cubemapCache;
+	mutable ResolvedObjectCache<JsonId, UMaterialInstanceConstant> materialInstanceCache;
+	mutable ResolvedObjectCache<JsonId, UMaterial> masterMaterialCache;
+	mutable ResolvedObjectCache<JsonId, USkeleton> skeletonCache;
+	mutable ResolvedObjectCache<AnimClipIdKey, UAnimSequence> animSequenceCache;
+
+	//Code generated material graphs, shared by materials with the same template key.
+	ResolvedObjectCache<MaterialTemplateKey, UMaterial> materialTemplateCache;
+	//Lightmap variants of materials. Instances are keyed by (material id, lightmap texture id).
+	ResolvedObjectCache<TPair<JsonId, JsonId>, UMaterialInstanceConstant> bakedLightmapInstanceCache;
+
+	//Generated materials sample occlusion, smoothness, metallic and detail mask from one packed texture.
+	bool packMaskTextures = true;
+	/*
+	Opt-in. Materials with two or more mask maps become instances of a generated packed mask template 
+	instead of instances of the shipped base materials. Requires packMaskTextures.
+	*/
+	bool packedMaskMaterialInstances = false;
+	ResolvedObjectCache<PackedMaskTexture::Sources, UTexture2D> packedMaskTextureCache;
+	TSet<PackedMaskTexture::Sources> failedPackedMasks;
+
+	//Rare static switch sets of material instances are folded into common ones. Built by loadMaterials.
+	StaticPermutationPlan::Settings staticPermutationSettings;
+	StaticPermutationPlan staticPermutationPlan;
+	//Textures that keep a switched on texture parameter neutral, keyed by (NeutralTexture, EMaterialSamplerType).
+	ResolvedObjectCache<TPair<int32, int32>, UTexture2D> neutralTextureCache;
+
 	//TMap<JsonId, Json
 	//IdNameMap animatorControllerIdMap;
 	//IdNameMap animationClipIdMap;
 
 	/*
-	For now let's just load them all
+	Clips are parsed and decomposed once, then shared between every skeleton/controller pair referencing them.
 	*/
-	TMap<JsonId, JsonAnimationClip> animationClipMap;
+	TMap<JsonId, TSharedPtr<PreparedAnimationClip>> preparedAnimClips;
 	TMap<JsonId, JsonAnimatorController> animatorControllerMap;
 
 	TMap<JsonId, JsonTerrainData> terrainDataMap;
 
+	//Spawn every scene object first, then register components and assign folders in a single pass.
+	bool deferObjectRegistration = true;
+
+	//Apply unity baked lightmaps to lightmapped static mesh renderers.
+	bool importBakedLightmaps = true;
+
+	MeshBuilderUtils::LightmapUvSettings lightmapUvSettings;
+
+	//Shadow budget and bake type conversion for scene lights. The report is saved into the project log directory.
+	LightAnalysis::Settings lightAnalysisSettings;
+	ReflectionCapturePlan::Settings reflectionCaptureSettings;
+	//Texture settings from unity import params and material usage. Usage is gathered by loadJsonMaterials.
+	TextureImportPolicy texturePolicy;
+	void saveLightReport(const LightAnalysis &lightAnalysis) const;
+	void saveImportReport(const TCHAR *reportType, const FString &report) const;
+
 	//This data should be reset between scenes. Otherwise thingsb ecome bad.
 	IdSet emissiveMaterials;
 	MaterialBuilder materialBuilder;
@@ -74,7 +130,8 @@ protected:
 	void registerMaterialInstancePath(int32 id, FString path);
 	void registerMasterMaterialPath(int32 id, FString path);
 
-	void importStaticMesh(const JsonMesh &jsonMesh, int32 meshId);
+	void importStaticMesh(const JsonMesh &jsonMesh, int32 meshId, const TArray<FVector> *convexHullPoints = nullptr, 
+		const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo = nullptr);
 	void importSkeletalMesh(const JsonMesh &jsonMesh, int32 meshId);
 
 	void loadAnimatorsDebug(const StringArray &animatorPaths);
@@ -82,6 +139,8 @@ protected:
 
 	void processDelayedAnimators(const TArray<JsonGameObject> &objects, ImportContext &workData);
 	void processDelayedAnimator(JsonId skelId, JsonId controllerId);
+	const JsonAnimatorController* findOrLoadAnimController(JsonId controllerId);
+	void prepareAnimationClips(const IntArray &clipIds);
 
 	template<typename T> bool loadIndexedExternResource(T& outObj, int index, const StringArray &resPaths) const{
 		if ((index < 0 ) || (index >= resPaths.Num())){
@@ -104,11 +163,11 @@ public:
 		return terrainDataMap;
 	}
 
-	const ResIdNameMap& getSkinMeshIdMap() const{
+	const ResIdPathMap& getSkinMeshIdMap() const{
 		return skinMeshIdMap;
 	}
 
-	const FString *findMeshPath(ResId meshId) const;
+	const FName *findMeshPath(ResId meshId) const;
 
 	UAnimSequence* getAnimSequence(AnimClipIdKey key) const;
 	void registerAnimSequence(AnimClipIdKey key, UAnimSequence *sequence);
@@ -144,6 +203,30 @@ public:
 
 	UMaterialInterface* loadMaterialInterface(int32 id) const;
 
+	bool usesBakedLightmaps() const{
+		return importBakedLightmaps;
+	}
+	bool appliesBakedLightmaps(const ImportContext &workData) const;
+	const MeshBuilderUtils::LightmapUvSettings& getLightmapUvSettings() const{
+		return lightmapUvSettings;
+	}
+	const ReflectionCapturePlan::Settings& getReflectionCaptureSettings() const{
+		return reflectionCaptureSettings;
+	}
+	UMaterialInterface* loadBakedLightmapMaterial(int32 matId, int32 lightmapTexId);
+	UMaterial* loadMaterialTemplate(const MaterialTemplateKey &key, const JsonMaterial &jsonMat, const MaterialTemplateParams &params);
+	bool usesPackedMaskTextures() const{
+		return packMaskTextures;
+	}
+	bool usesPackedMaskMaterialInstances() const{
+		return packMaskTextures && packedMaskMaterialInstances;
+	}
+	UTexture2D* loadPackedMaskTexture(const PackedMaskTexture::Sources &sources, const FString &materialPath);
+	const StaticPermutationPlan& getStaticPermutationPlan() const{
+		return staticPermutationPlan;
+	}
+	UTexture2D* loadNeutralTexture(StaticPermutationPlan::NeutralTexture neutral, EMaterialSamplerType samplerType);
+
 	FString getMeshPath(ResId id) const;
 	UStaticMesh *loadStaticMeshById(ResId id) const;
 	USkeletalMesh *loadSkeletalMeshById(ResId id) const;
@@ -153,7 +236,8 @@ public:
 	void importResources(const JsonExternResourceList &resources);
 	void loadCubemaps(const StringArray &cubemaps);
 	void loadTextures(const StringArray & textures);
-	void loadMaterials(const StringArray &materials);
+	void loadJsonMaterials(const StringArray &materials);
+	void loadMaterials();
 	void loadSkeletons(const StringArray &materials);
 	void loadMeshes(const StringArray &meshes);
 
@@ -168,7 +252,8 @@ public:
 	void importTexture(const JsonTexture &tex, const FString &rootPath);
 
 	void importMesh(JsonObjPtr obj, int32 meshId);
-	void importMesh(const JsonMesh &jsonMesh, int32 meshId);
+	void importMesh(const JsonMesh &jsonMesh, int32 meshId, const TArray<FVector> *convexHullPoints = nullptr, 
+		const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo = nullptr);
 	ImportedObject importObject(const JsonGameObject &jsonGameObj, ImportContext &importData, bool createEmptyTransforms = false);
 
 	static int findMatchingLength(const FString& arg1, const FString& arg2);
@@ -8,6 +8,8 @@
 #include "LocTextNamespace.h"
 
 #include "Runtime/Engine/Classes/Animation/AnimSequence.h"
+#include "Async/ParallelFor.h"
+#include "JsonObjects/JsonBinaryAnimationClip.h"
 
 #define LOCTEXT_NAMESPACE LOCTEXT_NAMESPACE_NAME
 
@@ -85,10 +87,84 @@ void JsonImporter::processAnimator(ImportContext &workData, const JsonGameObject
 	workData.registerDelayedAnimController(skelId, animatorId);
 }
 
+const JsonAnimatorController* JsonImporter::findOrLoadAnimController(JsonId controllerId){
+	auto found = animatorControllerMap.Find(controllerId);
+	if (found)
+		return found;
+
+	JsonAnimatorController animController;
+	if (!loadIndexedExternResource(animController, controllerId, externResources.animatorControllers)){
+		UE_LOG(JsonLog, Warning, TEXT("Could not load anim controller %d while processing delayed animators."), controllerId);
+		return nullptr;
+	}
+
+	return &animatorControllerMap.Add(controllerId, animController);
+}
+
+/*
+Json parsing and matrix decomposition run on worker threads. Asset creation stays on the game thread.
+
+When a binary sidecar (same path as clip json, "animbin" extension) exists, the clip is loaded from it and json is not parsed at all.
+*/
+void JsonImporter::prepareAnimationClips(const IntArray &clipIds){
+	TArray<TSharedPtr<PreparedAnimationClip>> results;
+	results.SetNum(clipIds.Num());
+
+	ParallelFor(clipIds.Num(), [&](int32 i){
+		const auto clipId = clipIds[i];
+		if ((clipId >= 0) && (clipId < externResources.animationClips.Num())){
+			auto sidecarPath = JsonBinaryAnimationClip::getSidecarPath(
+				FPaths::Combine(sourceExternDataPath, externResources.animationClips[clipId]));
+			if (FPaths::FileExists(sidecarPath)){
+				JsonBinaryAnimationClip binaryClip;
+				if (binaryClip.load(sidecarPath)){
+					auto prepared = MakeShared<PreparedAnimationClip>();
+					prepared->prepare(binaryClip);
+					results[i] = prepared;
+					return;
+				}
+				UE_LOG(JsonLog, Warning, TEXT("Could not load binary sidecar \"%s\" for clip %d, falling back to json"), *sidecarPath, clipId);
+			}
+		}
+
+		JsonAnimationClip animClip;
+		if (!loadIndexedExternResource(animClip, clipId, externResources.animationClips))
+			return;
+
+		auto prepared = MakeShared<PreparedAnimationClip>();
+		prepared->prepare(animClip);
+		results[i] = prepared;
+	});
+
+	for(int i = 0; i < clipIds.Num(); i++){
+		if (!results[i].IsValid()){
+			UE_LOG(JsonLog, Warning, TEXT("Could not load animation clip %d"), clipIds[i]);
+			continue;
+		}
+		preparedAnimClips.Add(clipIds[i], results[i]);
+	}
+}
+
 void JsonImporter::processDelayedAnimators(const TArray<JsonGameObject> &objects, ImportContext &workData){
-	FScopedSlowTask delayedAnimProgress(workData.delayedAnimControllers.Num(), 
+	FScopedSlowTask delayedAnimProgress(workData.delayedAnimControllers.Num() + 1, 
 		LOCTEXT("Processing animator controllers", "Processing animator controllers"));
 
+	IntArray pendingClipIds;
+	for(const auto& i: workData.delayedAnimControllers){
+		if ((i.Key < 0) || (i.Value < 0))
+			continue;
+		auto animController = findOrLoadAnimController(i.Value);
+		if (!animController)
+			continue;
+		for(const auto clipIndex: animController->animationIds){
+			if (!preparedAnimClips.Contains(clipIndex))
+				pendingClipIds.AddUnique(clipIndex);
+		}
+	}
+
+	prepareAnimationClips(pendingClipIds);
+	delayedAnimProgress.EnterProgressFrame();
+
 	for(const auto& i: workData.delayedAnimControllers){
 		processDelayedAnimator(i.Key, i.Value);
 		delayedAnimProgress.EnterProgressFrame();
@@ -120,25 +196,26 @@ void JsonImporter::processDelayedAnimator(JsonId skelId, JsonId controllerId){
 		return;
 	}
 
-	JsonAnimatorController animController;
-	if (!loadIndexedExternResource(animController, controllerId, externResources.animatorControllers)){
-		UE_LOG(JsonLog, Warning, TEXT("Could not load anim controller %d while processing delayed animators."), controllerId);
+	auto animController = findOrLoadAnimController(controllerId);
+	if (!animController){
 		return;
 	}
 
-	auto controllerPath = FPaths::GetPath(animController.path);
-	auto baseName = FPaths::GetBaseFilename(animController.path);
+	auto controllerPath = FPaths::GetPath(animController->path);
+	auto baseName = FPaths::GetBaseFilename(animController->path);
 
 	auto animBaseName = FString::Printf(TEXT("%s_skel%d"), *baseName, skelId);
 
 	auto clipDir = FString::Printf(TEXT("%s/%s"), *controllerPath, *animBaseName);
 
-	for(const auto clipIndex: animController.animationIds){
-		JsonAnimationClip animClip;
-		if (!loadIndexedExternResource(animClip, clipIndex, externResources.animationClips)){
+	for(const auto clipIndex: animController->animationIds){
+		auto foundClip = preparedAnimClips.Find(clipIndex);
+		if (!foundClip){
 			UE_LOG(JsonLog, Warning, TEXT("Coudl not load animation clip %d while processing animation with skelId: %d; controllerId: %d"),
 				clipIndex, skelId, controllerId);
+			continue;
 		}
+		const auto &animClip = **foundClip;
 
 		AnimationBuilder animBuilder;
 
@@ -30,6 +30,9 @@
 using namespace JsonObjects;
 
 UMaterialInstanceConstant* JsonImporter::loadMaterialInstance(int32 id) const{
+	if (auto cached = materialInstanceCache.find(id))
+		return cached;
+
 	UE_LOG(JsonLog, Log, TEXT("Looking for material instance %d"), id);
 	if (id < 0){
 		UE_LOG(JsonLog, Log, TEXT("Invalid id %d"), id);
@@ -41,15 +44,19 @@ UMaterialInstanceConstant* JsonImporter::loadMaterialInstance(int32 id) const{
 		UE_LOG(JsonLog, Log, TEXT("Id %d is not in the map"), id);
 		return 0;
 	}
-	auto matPath = *foundPath;
+	auto matPath = foundPath->ToString();
 	UMaterialInstanceConstant *mat = Cast<UMaterialInstanceConstant>(
 		StaticLoadObject(UMaterialInstanceConstant::StaticClass(), 0, *matPath));
+	materialInstanceCache.registerObject(id, mat);
 	UE_LOG(JsonLog, Log, TEXT("Material instance located"));
 	return mat;
 }
 
 
 UMaterial* JsonImporter::loadMasterMaterial(int32 id) const{
+	if (auto cached = masterMaterialCache.find(id))
+		return cached;
+
 	UE_LOG(JsonLog, Log, TEXT("Looking for material %d"), id);
 	if (id < 0){
 		UE_LOG(JsonLog, Log, TEXT("Invalid id %d"), id);
@@ -62,12 +69,43 @@ UMaterial* JsonImporter::loadMasterMaterial(int32 id) const{
 		return 0;
 	}
 
-	auto matPath = *foundPath;
+	auto matPath = foundPath->ToString();
 	UMaterial *mat = Cast<UMaterial>(StaticLoadObject(UMaterial::StaticClass(), 0, *matPath));
+	masterMaterialCache.registerObject(id, mat);
 	UE_LOG(JsonLog, Log, TEXT("Material located"));
 	return mat;
 }
 
+UMaterialInterface* JsonImporter::loadBakedLightmapMaterial(int32 matId, int32 lightmapTexId){
+	auto key = TPair<JsonId, JsonId>(matId, lightmapTexId);
+	if (auto cached = bakedLightmapInstanceCache.find(key))
+		return cached;
+
+	auto jsonMat = getJsonMaterial(matId);
+	if (!jsonMat){
+		UE_LOG(JsonLog, Warning, TEXT("Could not find material %d for baked lightmap %d"), matId, lightmapTexId);
+		return nullptr;
+	}
+
+	MaterialFingerprint fingerprint(*jsonMat);
+	MaterialTemplateParams params(*jsonMat, fingerprint, this);
+	auto templateMaterial = loadMaterialTemplate(MaterialTemplateKey(*jsonMat, fingerprint, params, true), *jsonMat, params);
+	if (!templateMaterial){
+		UE_LOG(JsonLog, Warning, TEXT("Could not create baked lightmap material for %d(%s)"), matId, *jsonMat->name);
+		return nullptr;
+	}
+
+	auto result = materialBuilder.createBakedLightmapInstance(*jsonMat, templateMaterial, params, lightmapTexId, this);
+	bakedLightmapInstanceCache.registerObject(key, result);
+	return result;
+}
+
+UMaterial* JsonImporter::loadMaterialTemplate(const MaterialTemplateKey &key, const JsonMaterial &jsonMat, const MaterialTemplateParams &params){
+	return materialTemplateCache.findOrLoad(key, [&](){
+		return materialBuilder.createTemplateMaterial(key, jsonMat, params, this);
+	});
+}
+
 const JsonMaterial* JsonImporter::getJsonMaterial(int32 id) const{
 	if ((id >= 0) && (id < jsonMaterials.Num()))
 		return &jsonMaterials[id];
@@ -38,7 +38,8 @@
 using namespace UnrealUtilities;
 using namespace JsonObjects;
 
-void JsonImporter::importStaticMesh(const JsonMesh &jsonMesh, int32 meshId){
+void JsonImporter::importStaticMesh(const JsonMesh &jsonMesh, int32 meshId, const TArray<FVector> *convexHullPoints, 
+		const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo){
 	auto unrealMeshName = jsonMesh.makeUnrealMeshName();
 	auto desiredDir = FPaths::GetPath(jsonMesh.path);
 	auto mesh = createAssetObject<UStaticMesh>(unrealMeshName, &desiredDir, this, 
@@ -50,7 +51,7 @@ void JsonImporter::importStaticMesh(const JsonMesh &jsonMesh, int32 meshId){
 					UMaterialInterface *material = loadMaterialInterface(matId);
 					materials.Add(material);
 				}
-			});
+			}, false, convexHullPoints, lightmapUvInfo);
 		},
 		[&](auto pkg, auto objName){
 			return NewObject<UStaticMesh>(pkg, FName(*objName), RF_Standalone|RF_Public);
@@ -59,7 +60,8 @@ void JsonImporter::importStaticMesh(const JsonMesh &jsonMesh, int32 meshId){
 
 	if (mesh){
 		auto meshPath = mesh->GetPathName();
-		meshIdMap.Add(jsonMesh.id, meshPath);
+		meshIdMap.Add(jsonMesh.id, FName(*meshPath));
+		staticMeshCache.registerObject(jsonMesh.id, mesh);
 	}
 }
 
@@ -99,11 +101,13 @@ void JsonImporter::importSkeletalMesh(const JsonMesh &jsonMesh, int32 meshId){
 
 	if (mesh){
 		auto meshPath = mesh->GetPathName();
-		skinMeshIdMap.Add(jsonMesh.id, meshPath);
+		skinMeshIdMap.Add(jsonMesh.id, FName(*meshPath));
+		skeletalMeshCache.registerObject(jsonMesh.id, mesh);
 	}
 }
 
-void JsonImporter::importMesh(const JsonMesh &jsonMesh, int32 meshId){
+void JsonImporter::importMesh(const JsonMesh &jsonMesh, int32 meshId, const TArray<FVector> *convexHullPoints, 
+		const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo){
 	UE_LOG(JsonLog, Log, TEXT("Importing mesh: %s(%d)"), *jsonMesh.name, jsonMesh.id.id)
 	UE_LOG(JsonLog, Log, TEXT("Mesh data: Verts: %d; submeshes: %d; materials: %d; colors %d; normals: %d"), 
 		jsonMesh.verts.Num(), jsonMesh.subMeshes.Num(), jsonMesh.colors.Num(), jsonMesh.normals.Num());
@@ -122,7 +126,7 @@ void JsonImporter::importMesh(const JsonMesh &jsonMesh, int32 meshId){
 	}
 	*/
 
-	importStaticMesh(jsonMesh, meshId);
+	importStaticMesh(jsonMesh, meshId, convexHullPoints, lightmapUvInfo);
 
 	if (jsonMesh.hasBlendShapes() || jsonMesh.hasBoneWeights()){
 		importSkeletalMesh(jsonMesh, meshId);
@@ -227,15 +227,15 @@ ImportedObject JsonImporter::importObject(const JsonGameObject &jsonGameObj, Imp
 
 		workData.registerGameObject(jsonGameObj, rootObject);
 		setObjectHierarchy(rootObject, parentObject, folderPath, workData, jsonGameObj);
-		rootObject.setFolderPath(folderPath, true);
+		workData.setFolderPath(rootObject, folderPath, true);
 
 		rootObject.fixEditorVisibility();
-		rootObject.convertToInstanceComponent();
+		workData.convertToInstanceComponent(rootObject);
 		for (auto& cur : createdObjects){
 			if (!cur.isValid() || (cur == rootObject))
 				continue;
 			cur.fixEditorVisibility();
-			cur.convertToInstanceComponent();
+			workData.convertToInstanceComponent(cur);
 		}
 	}
 
@@ -297,14 +297,14 @@ ImportedObject JsonImporter::importObject(const JsonGameObject &jsonGameObj, Imp
 }
 
 USkeletalMesh* JsonImporter::loadSkeletalMeshById(ResId id) const{
-	auto foundPath = skinMeshIdMap.Find(id);
-	if (!foundPath){
-		UE_LOG(JsonLog, Warning, TEXT("Could not load skin mesh %d"), id.toIndex());
-		return nullptr;
-	}
-
-	auto result = LoadObject<USkeletalMesh>(nullptr, **foundPath);
-	return result;
+	return skeletalMeshCache.findOrLoad(id, [&]() -> USkeletalMesh*{
+		auto foundPath = skinMeshIdMap.Find(id);
+		if (!foundPath){
+			UE_LOG(JsonLog, Warning, TEXT("Could not load skin mesh %d"), id.toIndex());
+			return nullptr;
+		}
+		return LoadObject<USkeletalMesh>(nullptr, *foundPath->ToString());
+	});
 }
 
 void JsonImporter::registerImportedObject(ImportedObjectArray *outArray, const ImportedObject &arg){
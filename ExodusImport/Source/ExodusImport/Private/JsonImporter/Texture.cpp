@@ -3,6 +3,7 @@
 #include "JsonImporter.h"
 
 #include "Engine/TextureCube.h"
+#include "Engine/Texture2D.h"
 #include "Factories/TextureFactory.h"
 
 #include "UnrealUtilities.h"
@@ -20,7 +21,9 @@ UTextureCube* JsonImporter::getCubemap(int32 id) const{
 }
 
 UTextureCube* JsonImporter::loadCubemap(int32 id) const{
-	return staticLoadResourceById<UTextureCube>(cubeIdMap, id, TEXT("cubemap"));
+	return cubemapCache.findOrLoad(id, [&](){
+		return staticLoadResourceById<UTextureCube>(cubeIdMap, id, TEXT("cubemap"));
+	});
 }
 
 bool loadTextureData(ByteArray &outData, const FString &path){
@@ -125,7 +128,8 @@ void JsonImporter::importCubemap(JsonObjPtr data, const FString &rootPath){
 		&packageName, &textureName, &existingTexture);
 
 	if (existingTexture){
-		cubeIdMap.Add(jsonCube.id, existingTexture->GetPathName());
+		cubeIdMap.Add(jsonCube.id, FName(*existingTexture->GetPathName()));
+		cubemapCache.registerObject(jsonCube.id, existingTexture);
 		UE_LOG(JsonLog, Warning, TEXT("Cube texture %s already exists, package %s"), *textureName, *packageName);
 		return;
 	}
@@ -208,7 +212,8 @@ void JsonImporter::importCubemap(JsonObjPtr data, const FString &rootPath){
 	//cubeTex->Source.
 
 	if (cubeTex){
-		cubeIdMap.Add(jsonCube.id, cubeTex->GetPathName());
+		cubeIdMap.Add(jsonCube.id, FName(*cubeTex->GetPathName()));
+		cubemapCache.registerObject(jsonCube.id, cubeTex);
 		cubeTex->PostEditChange();
 		FAssetRegistryModule::AssetCreated(cubeTex);
 		texturePackage->SetDirtyFlag(true);
@@ -222,7 +227,92 @@ UTexture* JsonImporter::getTexture(int32 id) const{
 }
 
 UTexture* JsonImporter::loadTexture(int32 id) const{
-	return staticLoadResourceById<UTexture>(texIdMap, id, TEXT("texture"));
+	return textureCache.findOrLoad(id, [&](){
+		return staticLoadResourceById<UTexture>(texIdMap, id, TEXT("texture"));
+	});
+}
+
+UTexture2D* JsonImporter::loadPackedMaskTexture(const PackedMaskTexture::Sources &sources, const FString &materialPath){
+	if (failedPackedMasks.Contains(sources))
+		return nullptr;
+
+	auto result = packedMaskTextureCache.findOrLoad(sources, [&](){
+		return PackedMaskTexture::createTexture(sources, materialPath, this);
+	});
+	if (!result)
+		failedPackedMasks.Add(sources);
+	return result;
+}
+
+/*
+Tiny constant textures for switched on texture parameters of materials that don't have the texture.
+The texture has to match the sampler type of the parameter, so there's one per neutral value and sampler type.
+*/
+UTexture2D* JsonImporter::loadNeutralTexture(StaticPermutationPlan::NeutralTexture neutral, EMaterialSamplerType samplerType){
+	if (neutral == StaticPermutationPlan::NeutralTexture::None)
+		return nullptr;
+
+	bool srgb = false;
+	auto compression = TC_Default;
+	const TCHAR *typeName = nullptr;
+	switch(samplerType){
+		case SAMPLERTYPE_Color:
+			srgb = true;
+			typeName = TEXT("Color");
+			break;
+		case SAMPLERTYPE_LinearColor:
+			typeName = TEXT("LinearColor");
+			break;
+		case SAMPLERTYPE_Grayscale:
+			srgb = true;
+			compression = TC_Grayscale;
+			typeName = TEXT("Grayscale");
+			break;
+		case SAMPLERTYPE_LinearGrayscale:
+			compression = TC_Grayscale;
+			typeName = TEXT("LinearGrayscale");
+			break;
+		case SAMPLERTYPE_Alpha:
+			compression = TC_Alpha;
+			typeName = TEXT("Alpha");
+			break;
+		case SAMPLERTYPE_Normal:
+			compression = TC_Normalmap;
+			typeName = TEXT("Normal");
+			break;
+		case SAMPLERTYPE_Masks:
+			compression = TC_Masks;
+			typeName = TEXT("Masks");
+			break;
+		default:
+			UE_LOG(JsonLog, Warning, TEXT("No neutral texture for sampler type %d"), (int32)samplerType);
+			return nullptr;
+	}
+
+	bool flatNormal = neutral == StaticPermutationPlan::NeutralTexture::FlatNormal;
+	auto key = TPair<int32, int32>((int32)neutral, (int32)samplerType);
+	return neutralTextureCache.findOrLoad(key, [&]() -> UTexture2D*{
+		const int32 size = 4;
+		TArray<FColor> pixels;
+		pixels.Init(flatNormal ? FColor(128, 128, 255, 255): FColor(255, 255, 255, 255), size * size);
+
+		auto texName = FString::Printf(TEXT("Neutral_%s_%s"), flatNormal ? TEXT("FlatNormal"): TEXT("White"), typeName);
+		FString dirPath = TEXT("NeutralTextures");
+		auto result = createAssetObject<UTexture2D>(texName, &dirPath, this,
+			[&](UTexture2D *tex){
+				tex->Source.Init(size, size, 1, 1, TSF_BGRA8, (const uint8*)pixels.GetData());
+				tex->SRGB = srgb;
+				tex->CompressionSettings = compression;
+				if (compression == TC_Normalmap)
+					tex->LODGroup = TEXTUREGROUP_WorldNormalMap;
+				tex->PostEditChange();
+			}, RF_Standalone|RF_Public
+		);
+		if (result){
+			UE_LOG(JsonLog, Log, TEXT("Neutral texture %s created"), *result->GetName());
+		}
+		return result;
+	});
 }
 
 void JsonImporter::importTexture(JsonObjPtr obj, const FString &rootPath){
@@ -234,18 +324,22 @@ void JsonImporter::importTexture(const JsonTexture &jsonTex, const FString &root
 	UE_LOG(JsonLog, Log, TEXT("Texture: %s, %s, %d x %d"), 
 		*jsonTex.path, *jsonTex.name, jsonTex.width, jsonTex.height);
 
-	bool isNormalMap = false;
-	
-	if (jsonTex.importDataFound && jsonTex.normalMapFlag){
-		isNormalMap = true;
+	TextureImportPolicy::Decision texDecision;
+	if (texturePolicy.getSettings().enabled){
+		texDecision = texturePolicy.decide(jsonTex);
 	}
-	else{
-		isNormalMap = jsonTex.name.EndsWith(FString("_n")) || jsonTex.name.EndsWith(FString("Normals"));
+	else if ((jsonTex.importDataFound && jsonTex.normalMapFlag) || jsonTex.name.EndsWith(FString("_n")) || jsonTex.name.EndsWith(FString("Normals"))){
+		texDecision.normalMap = true;
+		texDecision.lodGroup = TEXTUREGROUP_WorldNormalMap;
+		texDecision.compression = TC_Normalmap;
 	}
+	bool isNormalMap = texDecision.normalMap;
 
 	if (isNormalMap){
 		UE_LOG(JsonLog, Log, TEXT("Texture recognized as normalmap: %s(%s)"), *jsonTex.name, *jsonTex.path);
 	}
+	UE_LOG(JsonLog, Log, TEXT("Texture policy for %s: %s; srgb: %d; max size: %d; mips: %d"), 
+		*jsonTex.name, texDecision.reason, (int)texDecision.srgb, texDecision.maxTextureSize, (int)!texDecision.noMipmaps);
 
 	UTexture* existingTexture = 0;
 	FString ext = FPaths::GetExtension(jsonTex.path);
@@ -257,7 +351,8 @@ void JsonImporter::importTexture(const JsonTexture &jsonTex, const FString &root
 		&packageName, &textureName, &existingTexture);
 
 	if (existingTexture){
-		texIdMap.Add(jsonTex.id, existingTexture->GetPathName());
+		texIdMap.Add(jsonTex.id, FName(*existingTexture->GetPathName()));
+		textureCache.registerObject(jsonTex.id, existingTexture);
 		UE_LOG(JsonLog, Warning, TEXT("Texutre %s already exists, package %s"), *textureName, *packageName);
 		return;
 	}
@@ -293,17 +388,20 @@ void JsonImporter::importTexture(const JsonTexture &jsonTex, const FString &root
 	texFab->SuppressImportOverwriteDialog();
 	const uint8* data = binaryData.GetData();
 
-	if (isNormalMap){
-		texFab->LODGroup = TEXTUREGROUP_WorldNormalMap;
-		texFab->CompressionSettings = TC_Normalmap;
-	}
+	TextureImportPolicy::applyToFactory(texFab, texDecision);
 
 	UE_LOG(JsonLog, Log, TEXT("Attempting to create package: texName %s"), *jsonTex.name);
 	UTexture *unrealTexture = (UTexture*)texFab->FactoryCreateBinary(
 		UTexture2D::StaticClass(), texturePackage, *textureName, RF_Standalone|RF_Public, 0, *ext, data, data + binaryData.Num(), GWarn);
 
+	if (unrealTexture && texturePolicy.getSettings().enabled){
+		if (TextureImportPolicy::applyToTexture(unrealTexture, texDecision))
+			unrealTexture->PostEditChange();
+	}
+
 	if (unrealTexture){
-		texIdMap.Add(jsonTex.id, unrealTexture->GetPathName());
+		texIdMap.Add(jsonTex.id, FName(*unrealTexture->GetPathName()));
+		textureCache.registerObject(jsonTex.id, unrealTexture);
 		FAssetRegistryModule::AssetCreated(unrealTexture);
 		texturePackage->SetDirtyFlag(true);
 	}
@@ -83,6 +83,19 @@ public:
 		return data;
 	}
 
+	//Inclusive rectangular region, row by row.
+	DataArray getRegionArray(int32 minX, int32 minY, int32 maxX, int32 maxY) const{
+		check((minX >= 0) && (minY >= 0) && (maxX < width) && (maxY < height) && (minX <= maxX) && (minY <= maxY));
+		auto regionW = maxX - minX + 1;
+		auto regionH = maxY - minY + 1;
+		DataArray result;
+		result.SetNumUninitialized(regionW * regionH);
+		for(int32 y = 0; y < regionH; y++){
+			FMemory::Memcpy(&result[y * regionW], getRow(minY + y) + minX, sizeof(T) * regionW);
+		}
+		return result;
+	}
+
 	void saveToRaw(const FString& filename) const{
 		auto totalDataSize = sizeof(T) * numTotalEls;
 		const uint8* dataPtr = (const uint8*)data.GetData();
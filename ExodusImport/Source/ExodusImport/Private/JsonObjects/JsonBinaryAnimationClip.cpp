@@ -0,0 +1,164 @@
+#include "JsonImportPrivatePCH.h"
+#include "JsonBinaryAnimationClip.h"
+
+int32 JsonBinaryAnimationClip::getFloatsPerKey(KeyFormat format){
+	switch(format){
+		case KeyFormat::Matrix:
+			return 12;
+		case KeyFormat::Trs:
+			return 10;
+		default:
+			return 0;
+	}
+}
+
+FString JsonBinaryAnimationClip::getSidecarPath(const FString &clipJsonPath){
+	return FPaths::ChangeExtension(clipJsonPath, TEXT("animbin"));
+}
+
+void JsonBinaryAnimationClip::clear(){
+	name.Empty();
+	frameRate = 0.0f;
+	keyFormat = KeyFormat::Matrix;
+	curves.Empty();
+}
+
+JsonTransform JsonBinaryAnimationClip::getKeyTransform(const Curve &curve, int keyIndex) const{
+	const auto floatsPerKey = getFloatsPerKey(keyFormat);
+	const float *src = curve.data.GetData() + keyIndex * floatsPerKey;
+
+	JsonTransform result;
+	if (keyFormat == KeyFormat::Matrix){
+		result.x = FVector(src[0], src[1], src[2]);
+		result.y = FVector(src[3], src[4], src[5]);
+		result.z = FVector(src[6], src[7], src[8]);
+		result.pos = FVector(src[9], src[10], src[11]);
+		return result;
+	}
+
+	//Quaternion to matrix conversion does not depend on handedness, so unity axes come out as is.
+	auto pos = FVector(src[0], src[1], src[2]);
+	auto rot = FQuat(src[3], src[4], src[5], src[6]);
+	auto scale = FVector(src[7], src[8], src[9]);
+	rot.Normalize();
+
+	result.x = rot.RotateVector(FVector(1.0f, 0.0f, 0.0f)) * scale.X;
+	result.y = rot.RotateVector(FVector(0.0f, 1.0f, 0.0f)) * scale.Y;
+	result.z = rot.RotateVector(FVector(0.0f, 0.0f, 1.0f)) * scale.Z;
+	result.pos = pos;
+	return result;
+}
+
+class BinaryClipReader{
+public:
+	const uint8 *ptr = nullptr;
+	const uint8 *end = nullptr;
+	bool failed = false;
+
+	int64 getRemaining() const{
+		return (int64)(end - ptr);
+	}
+
+	/*
+	Marks the reader as failed if fewer than numBytes are left. Used to validate element counts before allocating for them.
+	*/
+	bool require(int64 numBytes){
+		if (failed || (numBytes < 0) || (numBytes > getRemaining()))
+			failed = true;
+		return !failed;
+	}
+
+	template<typename T> bool read(T &out){
+		return readElements(&out, 1);
+	}
+
+	template<typename T> bool readElements(T *dst, int32 numElements){
+		auto numBytes = (int64)sizeof(T) * (int64)numElements;
+		if (!require(numBytes))
+			return false;
+		FMemory::Memcpy(dst, ptr, numBytes);
+		ptr += numBytes;
+		return true;
+	}
+
+	bool readString(FString &out){
+		int32 len = 0;
+		if (!read(len))
+			return false;
+		if (!require(len))
+			return false;
+		TArray<ANSICHAR> utf8;
+		utf8.SetNumZeroed(len + 1);
+		if (!readElements(utf8.GetData(), len))
+			return false;
+		out = UTF8_TO_TCHAR(utf8.GetData());
+		return true;
+	}
+
+	BinaryClipReader(const TArray<uint8> &buffer)
+	:ptr(buffer.GetData()), end(buffer.GetData() + buffer.Num()){
+	}
+};
+
+bool JsonBinaryAnimationClip::load(const FString &filename){
+	clear();
+
+	TArray<uint8> fileBuffer;
+	if (!FFileHelper::LoadFileToArray(fileBuffer, *filename)){
+		UE_LOG(JsonLog, Error, TEXT("Could not load binary animation clip from \"%s\""), *filename);
+		return false;
+	}
+
+	BinaryClipReader reader(fileBuffer);
+
+	int32 fileMagic = 0, fileVersion = 0, fileKeyFormat = 0;
+	reader.read(fileMagic);
+	reader.read(fileVersion);
+	if (reader.failed || (fileMagic != magic) || (fileVersion != version)){
+		UE_LOG(JsonLog, Error, TEXT("File \"%s\" is not a supported binary animation clip (magic %x, version %d)"), 
+			*filename, fileMagic, fileVersion);
+		return false;
+	}
+
+	reader.read(fileKeyFormat);
+	reader.read(frameRate);
+	reader.readString(name);
+	keyFormat = (KeyFormat)fileKeyFormat;
+	const auto floatsPerKey = getFloatsPerKey(keyFormat);
+	if (floatsPerKey <= 0){
+		UE_LOG(JsonLog, Error, TEXT("Unknown key format %d in binary animation clip \"%s\""), fileKeyFormat, *filename);
+		return false;
+	}
+
+	int32 numCurves = 0;
+	reader.read(numCurves);
+	//Each curve takes at least its name length and key count.
+	const int64 minCurveBytes = 2 * sizeof(int32);
+	if (!reader.require((int64)numCurves * minCurveBytes)){
+		UE_LOG(JsonLog, Error, TEXT("Invalid header in binary animation clip \"%s\""), *filename);
+		return false;
+	}
+
+	const int64 keyBytes = sizeof(int32) + (int64)floatsPerKey * sizeof(float);
+	curves.SetNum(numCurves);
+	for(auto &curCurve: curves){
+		int32 numKeys = 0;
+		reader.readString(curCurve.objectName);
+		reader.read(numKeys);
+		if (!reader.require((int64)numKeys * keyBytes))
+			break;
+
+		curCurve.frames.SetNumUninitialized(numKeys);
+		curCurve.data.SetNumUninitialized(numKeys * floatsPerKey);
+		reader.readElements(curCurve.frames.GetData(), curCurve.frames.Num());
+		reader.readElements(curCurve.data.GetData(), curCurve.data.Num());
+	}
+
+	if (reader.failed){
+		UE_LOG(JsonLog, Error, TEXT("Binary animation clip \"%s\" is truncated"), *filename);
+		clear();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "JsonTypes.h"
+#include "JsonAnimation.h"
+
+/*
+Binary sidecar for animation clips. Stores local transforms of each matrix curve as flat arrays,
+so long clips can be loaded without going through json DOM.
+
+Layout (little endian):
+	int32 magic ('EXAC'), int32 version, int32 keyFormat, float frameRate, 
+	int32 nameLength, uint8 name[nameLength] (utf8), int32 numCurves,
+	per curve:
+		int32 nameLength, uint8 name[nameLength] (utf8), int32 numKeys,
+		int32 frames[numKeys], float data[numKeys * floatsPerKey]
+
+Data is in unity coordinate system.
+*/
+class JsonBinaryAnimationClip{
+public:
+	enum class KeyFormat: int32{
+		Matrix = 0, //x, y, z axes and position. 12 floats.
+		Trs = 1 //position, rotation quaternion (x, y, z, w), scale. 10 floats.
+	};
+
+	enum{
+		magic = 0x43415845, //"EXAC"
+		version = 1
+	};
+
+	class Curve{
+	public:
+		FString objectName;
+		IntArray frames;
+		FloatArray data;
+	};
+
+	FString name;
+	float frameRate = 0.0f;
+	KeyFormat keyFormat = KeyFormat::Matrix;
+	TArray<Curve> curves;
+
+	static int32 getFloatsPerKey(KeyFormat format);
+	JsonTransform getKeyTransform(const Curve &curve, int keyIndex) const;
+
+	static FString getSidecarPath(const FString &clipJsonPath);
+
+	void clear();
+	bool load(const FString &filename);
+	JsonBinaryAnimationClip() = default;
+};
@@ -12,6 +12,8 @@ void JsonLight::load(JsonObjPtr jsonData){
 	JSON_GET_PARAM(jsonData, bounceIntensity, getFloat);
 	JSON_GET_PARAM(jsonData, color, getColor);
 	JSON_GET_PARAM(jsonData, renderMode, getString);
+	lightmapBakeType.Empty();
+	jsonData->TryGetStringField(TEXT("lightmapBakeType"), lightmapBakeType);
 	JSON_GET_PARAM(jsonData, shadows, getString);
 	castsShadows = shadows != "Off";
 }
@@ -11,9 +11,21 @@ public:
 	float bounceIntensity;
 	FLinearColor color;
 	FString renderMode;
+	//Baked, Mixed or Realtime. Empty if the exporter did not provide it.
+	FString lightmapBakeType;
 	FString shadows;
 	bool castsShadows;
 
+	bool isImportant() const{
+		return renderMode == TEXT("ForcePixel");
+	}
+	bool isNotImportant() const{
+		return renderMode == TEXT("ForceVertex");
+	}
+	bool isLocal() const{
+		return (lightType == TEXT("Point")) || (lightType == TEXT("Spot"));
+	}
+
 	void load(JsonObjPtr jsonData);
 	JsonLight() = default;
 	JsonLight(JsonObjPtr jsonData);
@@ -0,0 +1,12 @@
+#include "JsonImportPrivatePCH.h"
+#include "JsonLightmap.h"
+
+void JsonLightmap::load(JsonObjPtr data){
+	//All maps are optional, and 0 is a valid texture id, so missing fields must not be read as zero.
+	colorTexId = -1;
+	dirTexId = -1;
+	shadowMaskTexId = -1;
+	data->TryGetNumberField(TEXT("lightmapColor"), colorTexId);
+	data->TryGetNumberField(TEXT("lightmapDir"), dirTexId);
+	data->TryGetNumberField(TEXT("shadowMask"), shadowMaskTexId);
+}
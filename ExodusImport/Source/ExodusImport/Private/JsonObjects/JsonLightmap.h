@@ -0,0 +1,23 @@
+#pragma once
+#include "JsonTypes.h"
+
+/*
+One entry of unity's LightmapSettings.lightmaps for a scene.
+Texture ids refer to exported textures, -1 if the map is absent.
+*/
+class JsonLightmap{
+public:
+	int32 colorTexId = -1;
+	int32 dirTexId = -1;
+	int32 shadowMaskTexId = -1;
+
+	bool hasColor() const{
+		return colorTexId >= 0;
+	}
+
+	void load(JsonObjPtr data);
+	JsonLightmap() = default;
+	JsonLightmap(JsonObjPtr data){
+		load(data);
+	}
+};
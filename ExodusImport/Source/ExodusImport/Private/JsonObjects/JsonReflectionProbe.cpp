@@ -22,6 +22,8 @@ void JsonReflectionProbe::load(JsonObjPtr jsonData){
 
 	JSON_GET_PARAM(jsonData, customCubemapId, getInt);
 	JSON_GET_PARAM(jsonData, customTex2dId, getInt);
+	bakedCubemapId = -1;
+	jsonData->TryGetNumberField(TEXT("bakedCubemapId"), bakedCubemapId);
 }
 
 JsonReflectionProbe::JsonReflectionProbe(JsonObjPtr jsonData){
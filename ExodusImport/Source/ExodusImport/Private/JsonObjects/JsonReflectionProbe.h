@@ -20,6 +20,15 @@ public:
 
 	int customCubemapId = -1;
 	int customTex2dId = -1;
+	//Cubemap unity baked for this probe, -1 if the exporter did not provide one.
+	int bakedCubemapId = -1;
+
+	bool isBaked() const{
+		return mode == TEXT("Baked");
+	}
+	bool isCustom() const{
+		return mode == TEXT("Custom");
+	}
 
 	void load(JsonObjPtr jsonData);
 	JsonReflectionProbe() = default;
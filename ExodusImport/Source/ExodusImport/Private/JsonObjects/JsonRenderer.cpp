@@ -6,6 +6,7 @@ void JsonRenderer::load(JsonObjPtr jsonData){
 	using namespace JsonObjects;
 
 	JSON_GET_PARAM(jsonData, lightmapIndex, getInt);
+	lightmapScaleOffset = getVector4(jsonData, "lightmapScaleOffset", FVector4(1.0f, 1.0f, 0.0f, 0.0f));
 	JSON_GET_PARAM(jsonData, shadowCastingMode, getString);
 	JSON_GET_PARAM(jsonData, receiveShadows, getBool);
 
@@ -5,7 +5,7 @@ class JsonRenderer{
 public:
 	int lightmapIndex = -1;
 	FString shadowCastingMode;
-	//FVector4 lightmapScaleOffset;
+	FVector4 lightmapScaleOffset = FVector4(1.0f, 1.0f, 0.0f, 0.0f);
 	TArray<int32> materials;
 	bool receiveShadows;
 
@@ -25,6 +25,20 @@ public:
 		return castsOneSidedShadows() || castsTwoSidedShadows() || castsShadowsOnly();
 	}
 
+	//65534 marks renderers that contribute to GI without being lightmapped, 65535 - not lightmapped at all.
+	bool hasLightmap() const{
+		return (lightmapIndex >= 0) && (lightmapIndex < 65534);
+	}
+
+	/*
+	Lightmap uv transform for unreal uv space. Mesh uvs are imported with V flipped, so the V offset becomes 1 - scale - offset.
+	Returns (scaleU, scaleV, offsetU, offsetV).
+	*/
+	FVector4 getUnrealLightmapScaleOffset() const{
+		return FVector4(lightmapScaleOffset.X, lightmapScaleOffset.Y, 
+			lightmapScaleOffset.Z, 1.0f - lightmapScaleOffset.Y - lightmapScaleOffset.W);
+	}
+
 	bool hasMaterials() const{
 		return materials.Num() > 0;
 	}
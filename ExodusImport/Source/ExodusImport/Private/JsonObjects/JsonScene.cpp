@@ -1,6 +1,7 @@
 #include "JsonImportPrivatePCH.h"
 #include "JsonScene.h"
 #include "macros.h"
+#include "Async/ParallelFor.h"
 
 
 void JsonScene::load(JsonObjPtr data){
@@ -10,27 +11,44 @@ void JsonScene::load(JsonObjPtr data){
 	JSON_GET_VAR(data, path);
 	JSON_GET_VAR(data, buildIndex);
 
-	getJsonObjArray(data, objects, "objects");
+	loadObjects(data);
+	index.build(objects);
 
-	buildInstanceIdMap();
+	lightmaps.Empty();
+	getJsonObjArray(data, lightmaps, "lightmaps", true);
 }
 
-void JsonScene::buildInstanceIdMap(){
-	gameObjectInstanceIdMap.Empty();
-	for (const auto& obj : objects){
-		auto instId = obj.instanceId;
-		auto objId = obj.id;
-
-		auto foundId = gameObjectInstanceIdMap.Find(instId);
-		if (foundId){
-			UE_LOG(JsonLog, Warning,
-				TEXT("Duplicate instance id found. New id objectId: %d; existing objectId: %d; instanceId: %d"),
-				objId, *foundId, instId
-			);
-			gameObjectInstanceIdMap.Remove(instId);
+/*
+Game objects don't reference each other's json data, so they're parsed in parallel chunks.
+Each json object is only touched by the thread that owns its chunk, which keeps 
+the non thread-safe shared pointer reference counts consistent.
+Derived data (ueName, ueWorldMatrix) is computed by JsonGameObject::load within the same pass.
+*/
+void JsonScene::loadObjects(JsonObjPtr data){
+	objects.Empty();
+	const TArray<JsonValPtr> *objectVals = nullptr;
+	if (!data->TryGetArrayField(TEXT("objects"), objectVals) || !objectVals)
+		return;
+
+	const auto numObjects = objectVals->Num();
+	objects.SetNum(numObjects);
+
+	const int32 chunkSize = 256;
+	const auto numChunks = FMath::DivideAndRoundUp(numObjects, chunkSize);
+	ParallelFor(numChunks, [&](int32 chunkIndex){
+		const auto start = chunkIndex * chunkSize;
+		const auto end = FMath::Min(start + chunkSize, numObjects);
+		for(int32 i = start; i < end; i++){
+			const auto &jsonVal = (*objectVals)[i];
+			const TSharedPtr<FJsonObject> *jsonObj = nullptr;
+			if (!jsonVal.IsValid() || !jsonVal->TryGetObject(jsonObj) || !jsonObj || !jsonObj->IsValid()){
+				UE_LOG(JsonLog, Warning, TEXT("Could not retrieve index %d from \"objects\""), i);
+				continue;
+			}
+			objects[i].load(*jsonObj);
 		}
-		gameObjectInstanceIdMap.Add(instId, objId);
-	}
+	});
+	UE_LOG(JsonLog, Log, TEXT("Scene \"%s\": %d objects loaded in %d chunks"), *name, numObjects, numChunks);
 }
 
 bool JsonScene::containsTerrain() const{
@@ -49,9 +67,5 @@ const JsonGameObject* JsonScene::findJsonObject(JsonId id) const{
 }
 
 const JsonGameObject* JsonScene::findJsonObjectByInstId(InstanceId instId) const{
-	auto foundId = gameObjectInstanceIdMap.Find(instId);
-	if (foundId){
-		return findJsonObject(*foundId);
-	}
-	return nullptr;
+	return index.findObjectByInstance(instId);
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "JsonObjects.h"
+#include "JsonSceneIndex.h"
+#include "JsonLightmap.h"
 
 class JsonScene{
 public:
@@ -8,8 +10,10 @@ public:
 	int buildIndex = -1;
 	using InstanceId = int;
 	TArray<JsonGameObject> objects;
+	TArray<JsonLightmap> lightmaps;
 
-	TMap<InstanceId, JsonId> gameObjectInstanceIdMap;
+	//Built once after loading. Refers to "objects", so the scene should not be copied afterwards.
+	JsonSceneIndex index;
 
 	bool containsTerrain() const;
 
@@ -22,5 +26,5 @@ public:
 		load(data);
 	}
 protected:
-	void buildInstanceIdMap();
+	void loadObjects(JsonObjPtr data);
 };
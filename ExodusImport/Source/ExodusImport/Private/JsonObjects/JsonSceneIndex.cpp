@@ -0,0 +1,114 @@
+#include "JsonImportPrivatePCH.h"
+#include "JsonSceneIndex.h"
+#include "JsonGameObject.h"
+
+uint32 JsonSceneIndex::gatherComponentFlags(const JsonGameObject &obj){
+	uint32 result = 0;
+	if (obj.hasMesh())
+		result |= CompMesh;
+	if (obj.hasTerrain())
+		result |= CompTerrain;
+	if (obj.hasSkinMeshes())
+		result |= CompSkinMesh;
+	if (obj.hasJoints())
+		result |= CompJoints;
+	if (obj.hasColliders())
+		result |= CompColliders;
+	if (obj.hasRigidbody())
+		result |= CompRigidbody;
+	if (obj.hasLights())
+		result |= CompLights;
+	if (obj.hasProbes())
+		result |= CompProbes;
+	if (obj.hasRenderers())
+		result |= CompRenderers;
+	if (obj.hasAnimators())
+		result |= CompAnimators;
+	return result;
+}
+
+void JsonSceneIndex::clear(){
+	objects = nullptr;
+	instanceIdMap.Empty();
+	parentIds.Empty();
+	childOffsets.Empty();
+	childIds.Empty();
+	componentFlags.Empty();
+	rootIds.Empty();
+}
+
+void JsonSceneIndex::build(const TArray<JsonGameObject> &srcObjects){
+	clear();
+	objects = &srcObjects;
+	const auto numObjects = srcObjects.Num();
+
+	instanceIdMap.Reserve(numObjects);
+	parentIds.SetNumUninitialized(numObjects);
+	componentFlags.SetNumUninitialized(numObjects);
+	childOffsets.SetNumZeroed(numObjects + 1);
+
+	for(int32 i = 0; i < numObjects; i++){
+		const auto &obj = srcObjects[i];
+		auto foundId = instanceIdMap.Find(obj.instanceId);
+		if (foundId){
+			UE_LOG(JsonLog, Warning,
+				TEXT("Duplicate instance id found. New id objectId: %d; existing objectId: %d; instanceId: %d"),
+				obj.id, *foundId, obj.instanceId
+			);
+		}
+		instanceIdMap.Add(obj.instanceId, i);
+
+		componentFlags[i] = gatherComponentFlags(obj);
+		auto parentId = ((obj.parentId >= 0) && (obj.parentId < numObjects)) ? obj.parentId: -1;
+		parentIds[i] = parentId;
+		if (parentId >= 0)
+			childOffsets[parentId + 1]++;
+		else
+			rootIds.Add(i);
+	}
+
+	for(int32 i = 0; i < numObjects; i++)
+		childOffsets[i + 1] += childOffsets[i];
+
+	childIds.SetNumUninitialized(childOffsets[numObjects]);
+	TArray<int32> fillPos(childOffsets.GetData(), numObjects);
+	for(int32 i = 0; i < numObjects; i++){
+		auto parentId = parentIds[i];
+		if (parentId >= 0)
+			childIds[fillPos[parentId]++] = i;
+	}
+}
+
+const JsonGameObject* JsonSceneIndex::findObject(JsonId id) const{
+	if (!objects || !isValidObjectId(id))
+		return nullptr;
+	return &(*objects)[id];
+}
+
+const JsonGameObject* JsonSceneIndex::findObjectByInstance(InstanceId instId) const{
+	auto foundId = instanceIdMap.Find(instId);
+	if (!foundId)
+		return nullptr;
+	return findObject(*foundId);
+}
+
+const JsonGameObject* JsonSceneIndex::resolveObjectReference(const JsonObjectReference &ref) const{
+	if (ref.isNull)
+		return nullptr;
+	return findObjectByInstance(ref.instanceId);
+}
+
+TArrayView<const JsonId> JsonSceneIndex::getChildIds(JsonId id) const{
+	if (!isValidObjectId(id))
+		return TArrayView<const JsonId>();
+	auto start = childOffsets[id];
+	return TArrayView<const JsonId>(childIds.GetData() + start, childOffsets[id + 1] - start);
+}
+
+bool JsonSceneIndex::anyObjectHas(uint32 flags) const{
+	for(auto cur: componentFlags){
+		if (cur & flags)
+			return true;
+	}
+	return false;
+}
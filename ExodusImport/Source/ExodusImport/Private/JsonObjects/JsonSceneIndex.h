@@ -0,0 +1,76 @@
+#pragma once
+#include "JsonTypes.h"
+#include "JsonPhysics.h"
+#include "Containers/ArrayView.h"
+
+class JsonGameObject;
+
+/*
+Precomputed, read-only lookup tables for one scene (or prefab) object array.
+
+Built once after the objects are loaded and shared by every builder, so nobody needs to copy
+game objects or build private instance id maps.
+Object ids are indices into the source array. Children are stored as a flat adjacency list.
+*/
+class JsonSceneIndex{
+public:
+	using InstanceId = int32;
+	enum ComponentFlags: uint32{
+		CompMesh = 1 << 0,
+		CompTerrain = 1 << 1,
+		CompSkinMesh = 1 << 2,
+		CompJoints = 1 << 3,
+		CompColliders = 1 << 4,
+		CompRigidbody = 1 << 5,
+		CompLights = 1 << 6,
+		CompProbes = 1 << 7,
+		CompRenderers = 1 << 8,
+		CompAnimators = 1 << 9
+	};
+protected:
+	const TArray<JsonGameObject> *objects = nullptr;
+	TMap<InstanceId, JsonId> instanceIdMap;
+	TArray<JsonId> parentIds;
+	TArray<int32> childOffsets;
+	TArray<JsonId> childIds;
+	TArray<uint32> componentFlags;
+	TArray<JsonId> rootIds;
+
+	static uint32 gatherComponentFlags(const JsonGameObject &obj);
+public:
+	void build(const TArray<JsonGameObject> &srcObjects);
+	void clear();
+
+	bool isValidObjectId(JsonId id) const{
+		return (id >= 0) && (id < componentFlags.Num());
+	}
+	int32 num() const{
+		return componentFlags.Num();
+	}
+	bool isEmpty() const{
+		return num() == 0;
+	}
+
+	const JsonGameObject* findObject(JsonId id) const;
+	const JsonId* findIdByInstance(InstanceId instId) const{
+		return instanceIdMap.Find(instId);
+	}
+	const JsonGameObject* findObjectByInstance(InstanceId instId) const;
+	const JsonGameObject* resolveObjectReference(const JsonObjectReference &ref) const;
+
+	JsonId getParentId(JsonId id) const{
+		return isValidObjectId(id) ? parentIds[id]: -1;
+	}
+	TArrayView<const JsonId> getChildIds(JsonId id) const;
+	const TArray<JsonId>& getRootIds() const{
+		return rootIds;
+	}
+
+	uint32 getComponentFlags(JsonId id) const{
+		return isValidObjectId(id) ? componentFlags[id]: 0;
+	}
+	bool hasComponents(JsonId id, uint32 flags) const{
+		return (getComponentFlags(id) & flags) != 0;
+	}
+	bool anyObjectHas(uint32 flags) const;
+};
@@ -20,6 +20,8 @@ void JsonTextureImportParams::load(JsonObjPtr data){
 	JSON_GET_VAR(data, maxTextureSize);
 	JSON_GET_VAR(data, mipmapFadeDistanceEnd);
 	JSON_GET_VAR(data, mipmapFadeDistanceStart);
+	mipmapEnabled = true;
+	data->TryGetBoolField(TEXT("mipmapEnabled"), mipmapEnabled);
 	JSON_GET_VAR2(data, mipmapsPreserveCoverage, mipMapsPreserveCoverage);
 	JSON_GET_VAR(data, heightmapScale);
 	JSON_GET_VAR(data, npotScale);
@@ -17,6 +17,7 @@ public:
 	int maxTextureSize;
 	int mipmapFadeDistanceEnd;
 	int mipmapFadeDistanceStart;
+	bool mipmapEnabled = true;
 	bool mipmapsPreserveCoverage;
 	float heightmapScale;
 	FString npotScale;
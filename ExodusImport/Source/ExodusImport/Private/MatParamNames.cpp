@@ -1,2 +1,31 @@
 #include "JsonImportPrivatePCH.h"
-#include "MatParamNames.h"
\ No newline at end of file
+#include "MatParamNames.h"
+
+namespace MatParamNames{
+	const TCHAR* mainUvScale = TEXT("Main UV scale");
+	const TCHAR* mainUvOffset = TEXT("Main UV offset");
+	const TCHAR* detailUvScale = TEXT("Detail UV scale");
+	const TCHAR* detailUvOffset = TEXT("Detail UV offset");
+
+	const TCHAR* albedoColor = TEXT("Albedo Color");
+	const TCHAR* albedoTex = TEXT("Albedo Texture");
+	const TCHAR* detailAlbedoTex = TEXT("Detail Map(Albedo)");
+	const TCHAR* normalTex = TEXT("Normal Map(main)");
+	const TCHAR* bumpScale = TEXT("Bump Scale (Normal intensity)");
+	const TCHAR* detailNormalTex = TEXT("Normal Map(detail)");
+	const TCHAR* detailNormalScale = TEXT("Detail Normal Scale (DetailNormal intensity)");
+	const TCHAR* emissiveColor = TEXT("Emissive color");
+	const TCHAR* emissiveTex = TEXT("Emissive Texture");
+	const TCHAR* detailMaskTex = TEXT("Detail texture");
+	const TCHAR* occlusionTex = TEXT("Occlusion texture");
+	const TCHAR* occlusionStrength = TEXT("Occlusion intensity");
+	const TCHAR* metallic = TEXT("Metallic");
+	const TCHAR* metallicTex = TEXT("Metallic (texture)");
+	const TCHAR* specularColor = TEXT("Specular (color)");
+	const TCHAR* specularTex = TEXT("Specular (texture)");
+	const TCHAR* roughness = TEXT("Roughness");
+	const TCHAR* packedMaskTex = TEXT("Packed masks (occlusion, smoothness, metallic, detail mask)");
+
+	const TCHAR* bakedLightmap = TEXT("bakedLightmap");
+	const TCHAR* bakedLightmapIntensity = TEXT("bakedLightmapIntensity");
+}
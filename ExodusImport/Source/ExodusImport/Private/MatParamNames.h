@@ -1 +1,35 @@
-#pragma once
\ No newline at end of file
+#pragma once
+#include "CoreMinimal.h"
+
+/*
+Parameter names used by code generated materials. Template graphs are built with these names,
+and instances of the templates override values by the same names.
+*/
+namespace MatParamNames{
+	extern const TCHAR* mainUvScale;
+	extern const TCHAR* mainUvOffset;
+	extern const TCHAR* detailUvScale;
+	extern const TCHAR* detailUvOffset;
+
+	extern const TCHAR* albedoColor;
+	extern const TCHAR* albedoTex;
+	extern const TCHAR* detailAlbedoTex;
+	extern const TCHAR* normalTex;
+	extern const TCHAR* bumpScale;
+	extern const TCHAR* detailNormalTex;
+	extern const TCHAR* detailNormalScale;
+	extern const TCHAR* emissiveColor;
+	extern const TCHAR* emissiveTex;
+	extern const TCHAR* detailMaskTex;
+	extern const TCHAR* occlusionTex;
+	extern const TCHAR* occlusionStrength;
+	extern const TCHAR* metallic;
+	extern const TCHAR* metallicTex;
+	extern const TCHAR* specularColor;
+	extern const TCHAR* specularTex;
+	extern const TCHAR* roughness;
+	extern const TCHAR* packedMaskTex;
+
+	extern const TCHAR* bakedLightmap;
+	extern const TCHAR* bakedLightmapIntensity;
+}
@@ -2,6 +2,8 @@
 
 #include "JsonTypes.h"
 #include "MaterialBuilder/MaterialFingerprint.h"
+#include "MaterialBuilder/MaterialTemplate.h"
+#include "MaterialBuilder/StaticPermutationPlan.h"
 #include "JsonObjects/JsonGameObject.h"
 #include "JsonObjects/JsonTerrainData.h"
 #include "JsonObjects/JsonTerrain.h"
@@ -34,6 +36,12 @@ public:
 
 	UMaterialExpression *detailMaskExpression = nullptr;
 
+	//Occlusion, smoothness, metallic and detail mask packed into one texture, see PackedMaskTexture
+	UMaterialExpression *packedMaskExpression = nullptr;
+
+	//Parameter defaults of the generated graph
+	MaterialTemplateParams params;
+
 	UMaterialExpression *metallicTexExpression = nullptr;
 	UMaterialExpression *specularTexExpression = nullptr;
 	UMaterialExpression *specularColorExpression = nullptr;
@@ -44,6 +52,9 @@ public:
 	UMaterialExpression *metallicExpression = nullptr;
 	UMaterialExpression *emissiveExpression = nullptr;
 
+	//Adds unity baked lighting to emissive, see MaterialBuilder::processBakedLightmap
+	bool bakedLightmap = false;
+
 	MaterialBuildData(JsonMaterialId matId_, JsonImporter *importer_)
 	:matId(matId_), importer(importer_){
 	}
@@ -60,6 +71,31 @@ public:
 
 	UMaterialInstanceConstant* importMaterialInstance(const JsonMaterial& jsonMat, JsonImporter *importer);
 
+	/*
+	The shipped base materials sample occlusion, metallic and detail mask separately. Materials that reference at least two
+	of them become instances of a generated template graph that samples one packed mask texture instead.
+	Only with JsonImporter::packedMaskMaterialInstances, off by default.
+	*/
+	bool usesPackedMaskTemplate(const JsonMaterial& jsonMat, const JsonImporter *importer) const;
+	UMaterialInstanceConstant* importPackedMaskInstance(const JsonMaterial& jsonMat, JsonImporter *importer);
+
+	/*
+	Code generated graphs are shared by all materials with the same MaterialTemplateKey. The template is built and laid out once,
+	using values of the first material as parameter defaults. Materials become instances that override the parameters.
+	Packed mask materials and baked lightmap variants are built this way.
+	*/
+	UMaterial* createTemplateMaterial(const MaterialTemplateKey &key, const JsonMaterial& jsonMat, const MaterialTemplateParams &params, JsonImporter *importer);
+	UMaterialInstanceConstant* createTemplateInstance(const FString &name, const JsonMaterial& jsonMat, UMaterial *templateMaterial, 
+		const MaterialTemplateParams &params, JsonImporter *importer, 
+		std::function<void(UMaterialInstanceConstant* matInst)> postConfig = nullptr);
+
+	/*
+	Instance of a baked lightmap template for one material and lightmap.
+	The lightmap uv transform is read from custom primitive data 0..3, the lightmap itself is the "bakedLightmap" parameter.
+	*/
+	UMaterialInstanceConstant* createBakedLightmapInstance(const JsonMaterial& jsonMat, UMaterial *templateMaterial, 
+		const MaterialTemplateParams &params, int32 lightmapTexId, JsonImporter *importer);
+
 	UMaterialInstanceConstant* createMaterialInstance(const FString& name, const FString *dirPath, UMaterial* baseMaterial, JsonImporter *importer, 
 		std::function<void(UMaterialInstanceConstant* matInst)> postConfig);
 
@@ -90,6 +126,12 @@ public:
 	bool setStaticSwitch(FStaticParameterSet &paramSet, const char *switchName, bool newValue) const;
 	bool setTexParams(UMaterialInstanceConstant *matInst,  FStaticParameterSet &paramSet, int32 texId, 
 		const char *switchName, const char *texParamName, const JsonImporter *importer) const;
+	/*
+	Texture that keeps the output of a switched on texture parameter unchanged, matching the sampler type the parent material
+	declares for that parameter. Used when the permutation plan turns on a switch for a material without the texture.
+	*/
+	UTexture* getNeutralSwitchTexture(UMaterialInstanceConstant *matInst, const char *texParamName, 
+		StaticPermutationPlan::NeutralTexture neutral, JsonImporter *importer) const;
 protected:
 
 	void  setupBillboardMatInstance(UMaterialInstanceConstant *result, const JsonTerrainDetailPrototype *detailPrototype, 
@@ -112,7 +154,9 @@ protected:
 	void processOcclusion(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 	void processMetallic(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 	void processSpecular(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
+	void processPackedMasks(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 	void processDetailMask(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 	void processRoughness(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 	void processParallax(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
+	void processBakedLightmap(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData);
 };
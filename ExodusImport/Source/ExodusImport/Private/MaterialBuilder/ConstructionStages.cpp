@@ -5,6 +5,12 @@
 #include "JsonImporter.h"
 #include "JsonObjects/utilities.h"
 #include "UnrealUtilities.h"
+#include "MatParamNames.h"
+#include "Materials/MaterialExpressionTextureSampleParameter2D.h"
+#include "Engine/Texture2D.h"
+#ifdef EXODUS_UE_VER_4_26_GE
+#include "Materials/MaterialExpressionCustomPrimitiveData.h"
+#endif
 
 //#define MATBUILDER_OLDGEN
 
@@ -71,8 +77,8 @@ void MaterialBuilder::processMainUv(UMaterial* material, const JsonMaterial &jso
 		&& !fingerprint.detailMaskTex && !fingerprint.emissionTex)
 		return;
 
-	auto coordExpr = makeTextureTransformNodes(material, jsonMat.mainTextureScale, jsonMat.mainTextureOffset, 0, 
-		TEXT("Main UV coords"), TEXT("Main UV scale"), TEXT("Main UV offset"));
+	auto coordExpr = makeTextureTransformNodes(material, buildData.params.mainUvScale, buildData.params.mainUvOffset, 0, 
+		TEXT("Main UV coords"), MatParamNames::mainUvScale, MatParamNames::mainUvOffset);
 
 	buildData.mainUv = coordExpr;
 }
@@ -97,8 +103,8 @@ void MaterialBuilder::processDetailUv(UMaterial* material, const JsonMaterial &j
 	if (!fingerprint.detailAlbedoTex && !fingerprint.detailNormalTex)
 		return;
 
-	auto texCoord = makeTextureTransformNodes(material, jsonMat.detailAlbedoScale, jsonMat.detailAlbedoOffset, jsonMat.secondaryUv, 
-		TEXT("Detail UV coords"), TEXT("Detail UV scale"), TEXT("Detail UV offset"), !fingerprint.detailTextureTransform);
+	auto texCoord = makeTextureTransformNodes(material, buildData.params.detailUvScale, buildData.params.detailUvOffset, jsonMat.secondaryUv, 
+		TEXT("Detail UV coords"), MatParamNames::detailUvScale, MatParamNames::detailUvOffset, !fingerprint.detailTextureTransform);
 
 	buildData.detailUv = texCoord;
 }
@@ -106,15 +112,15 @@ void MaterialBuilder::processDetailUv(UMaterial* material, const JsonMaterial &j
 void MaterialBuilder::processAlbedo(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
 	UE_LOG(JsonLog, Log, TEXT("Creating albedo"));
 
-	auto albedoColorExpr = createVectorParameterExpression(material, jsonMat.colorGammaCorrected, TEXT("Albedo Color"));
+	auto albedoColorExpr = createVectorParameterExpression(material, buildData.params.albedoColor, MatParamNames::albedoColor);
 	buildData.albedoExpression = albedoColorExpr;
 	buildData.albedoColorExpression = albedoColorExpr;
 
 	//texture
 	if (fingerprint.albedoTex){
-		auto albedoTex = buildData.importer->getTexture(jsonMat.albedoTex);
+		auto albedoTex = buildData.params.albedoTex;
 		if (albedoTex){
-			auto texExpr = createTextureExpression(material, albedoTex, TEXT("Albedo Texture"), false);
+			auto texExpr = createTextureParameterExpression(material, albedoTex, MatParamNames::albedoTex, false);
 
 			buildData.albedoTexExpression = texExpr;
 			if (buildData.mainUv){
@@ -130,9 +136,9 @@ void MaterialBuilder::processAlbedo(UMaterial* material, const JsonMaterial &jso
 
 	//detail
 	if (fingerprint.detailAlbedoTex){
-		auto detailAlbedoTex = buildData.importer->getTexture(jsonMat.detailAlbedoTex);
+		auto detailAlbedoTex = buildData.params.detailAlbedoTex;
 		if (detailAlbedoTex){
-			auto texExpr = createTextureExpression(material, detailAlbedoTex, TEXT("Detail Map(Albedo"), false);
+			auto texExpr = createTextureParameterExpression(material, detailAlbedoTex, MatParamNames::detailAlbedoTex, false);
 			buildData.albedoDetailTexExpression = texExpr;
 			if (buildData.detailUv){
 				texExpr->Coordinates.Expression = buildData.detailUv;
@@ -165,9 +171,8 @@ void MaterialBuilder::processAlbedo(UMaterial* material, const JsonMaterial &jso
 }
 
 void MaterialBuilder::processNormalMap(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
-	if (fingerprint.normalmapTex){
-		auto normalMapTex = buildData.importer->getTexture(jsonMat.normalMapTex);
-		auto normTexExpr = createTextureExpression(material, normalMapTex, TEXT("Normal Map(main)"), true);
+	if (fingerprint.normalmapTex && buildData.params.normalTex){
+		auto normTexExpr = createTextureParameterExpression(material, buildData.params.normalTex, MatParamNames::normalTex, true);
 		if (buildData.mainUv){
 			normTexExpr->Coordinates.Expression = buildData.mainUv;
 		}
@@ -176,15 +181,14 @@ void MaterialBuilder::processNormalMap(UMaterial* material, const JsonMaterial &
 
 		if (fingerprint.normalMapIntensity){
 			auto bumpScaleParam = createScalarParameterExpression(
-				material, jsonMat.bumpScale, TEXT("Bump Scale (Normal intensity)"));
+				material, buildData.params.bumpScale, MatParamNames::bumpScale);
 			auto scale = makeNormalMapScaler(material, normTexExpr, bumpScaleParam);
 			buildData.normalExpression = scale;
 		}
 	}
 
-	if (fingerprint.detailNormalTex){
-		auto detailNormalMapTex = buildData.importer->getTexture(jsonMat.detailNormalMapTex);
-		auto detNormTexExpr = createTextureExpression(material, detailNormalMapTex, TEXT("Normal Map(detail)"), true);
+	if (fingerprint.detailNormalTex && buildData.params.detailNormalTex){
+		auto detNormTexExpr = createTextureParameterExpression(material, buildData.params.detailNormalTex, MatParamNames::detailNormalTex, true);
 		buildData.detailNormalTexExpression = detNormTexExpr;
 		buildData.detailNormalExpression = detNormTexExpr;
 		if (buildData.detailUv){
@@ -193,7 +197,7 @@ void MaterialBuilder::processNormalMap(UMaterial* material, const JsonMaterial &
 
 		if (fingerprint.detailNormalMapScale){
 			auto detailNormScaleParam = createScalarParameterExpression(
-				material, jsonMat.bumpScale, TEXT("Detail Normal Scale (DetailNormal intensity)"));
+				material, buildData.params.detailNormalScale, MatParamNames::detailNormalScale);
 			auto detScale = makeNormalMapScaler(material, detNormTexExpr, detailNormScaleParam);
 			buildData.detailNormalExpression  = detScale;
 		}
@@ -216,12 +220,12 @@ void MaterialBuilder::processEmissive(UMaterial* material, const JsonMaterial &j
 	if (!fingerprint.emissionEnabled)
 		return;
 
-	auto emissiveColor = createVectorParameterExpression(material, jsonMat.emissionColor, TEXT("Emissive color"));
+	auto emissiveColor = createVectorParameterExpression(material, buildData.params.emissiveColor, MatParamNames::emissiveColor);
 	UMaterialExpression *emissiveExpr = emissiveColor;
 
-	UTexture *emissiveTex = buildData.importer->getTexture(jsonMat.emissionTex);
+	UTexture *emissiveTex = buildData.params.emissiveTex;
 	if (emissiveTex){
-		auto emissiveTexExpr = createTextureExpression(material, emissiveTex, TEXT("Emissive Texture"));
+		auto emissiveTexExpr = createTextureParameterExpression(material, emissiveTex, MatParamNames::emissiveTex);
 		if (buildData.mainUv)
 			emissiveTexExpr->Coordinates.Expression = buildData.mainUv;
 		auto mul = createExpression<UMaterialExpressionMultiply>(material);
@@ -234,13 +238,80 @@ void MaterialBuilder::processEmissive(UMaterial* material, const JsonMaterial &j
 	material->EmissiveColor.Expression = emissiveExpr;
 }
 
+/*
+Unity lightmaps hold incoming diffuse light, so the baked contribution is albedo * lightmap, added to emissive.
+Lightmap uv is uv1 * scale + offset, where (scaleU, scaleV, offsetU, offsetV) are stored per component in custom primitive data.
+*/
+void MaterialBuilder::processBakedLightmap(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
+#ifdef EXODUS_UE_VER_4_26_GE
+	auto lightmapUv = createExpression<UMaterialExpressionTextureCoordinate>(material);
+	lightmapUv->CoordinateIndex = 1;
+
+	UMaterialExpressionCustomPrimitiveData* primData[4];
+	for(int32 i = 0; i < 4; i++){
+		primData[i] = createExpression<UMaterialExpressionCustomPrimitiveData>(material);
+		primData[i]->PrimitiveDataIndex = i;
+	}
+	auto lightmapScale = createAppendVectorExpression(material, primData[0], primData[1], TEXT("Lightmap scale"));
+	auto lightmapOffset = createAppendVectorExpression(material, primData[2], primData[3], TEXT("Lightmap offset"));
+	auto scaledUv = createMulExpression(material, lightmapUv, lightmapScale);
+	auto finalUv = createAddExpression(material, scaledUv, lightmapOffset);
+
+	auto lightmapTex = createExpression<UMaterialExpressionTextureSampleParameter2D>(material);
+	lightmapTex->ParameterName = MatParamNames::bakedLightmap;
+	lightmapTex->Desc = MatParamNames::bakedLightmap;
+	lightmapTex->Texture = LoadObject<UTexture2D>(nullptr, TEXT("/Engine/EngineResources/WhiteSquareTexture"));
+	lightmapTex->SamplerType = SAMPLERTYPE_LinearColor;
+	lightmapTex->Coordinates.Expression = finalUv;
+
+	auto intensity = createScalarParameterExpression(material, 1.0f, MatParamNames::bakedLightmapIntensity);
+	auto lightmapColor = createComponentMask(material, lightmapTex, true, true, true, false);
+	auto scaledLight = createMulExpression(material, lightmapColor, intensity);
+
+	UMaterialExpression *bakedExpr = scaledLight;
+	auto albedo = material->BaseColor.Expression ? material->BaseColor.Expression: buildData.albedoExpression;
+	if (albedo)
+		bakedExpr = createMulExpression(material, albedo, scaledLight);
+
+	if (material->EmissiveColor.Expression)
+		bakedExpr = createAddExpression(material, material->EmissiveColor.Expression, bakedExpr);
+	material->EmissiveColor.Expression = bakedExpr;
+#else
+	UE_LOG(JsonLog, Warning, TEXT("Baked lightmaps require custom primitive data (4.26 or later), material %d(%s) is built without them"),
+		jsonMat.id, *jsonMat.name);
+#endif
+}
+
+/*
+One sample of the packed mask texture replaces separate occlusion, metallic/smoothness and detail mask samples.
+Later stages read their channel from packedMaskExpression when their source is part of params.packedMasks.
+*/
+void MaterialBuilder::processPackedMasks(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
+	if (!buildData.params.packedMaskTex)
+		return;
+
+	auto texExpr = createTextureParameterExpression(material, buildData.params.packedMaskTex, MatParamNames::packedMaskTex);
+	if (buildData.mainUv){
+		texExpr->Coordinates.Expression = buildData.mainUv;
+	}
+	buildData.packedMaskExpression = texExpr;
+}
+
 void MaterialBuilder::processDetailMask(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
 	if (!fingerprint.detailMaskTex || !fingerprint.hasDetailMaps())
 		return;
 
-	auto detailTex = buildData.importer->getTexture(jsonMat.detailMaskTex);
+	//detail mask is read from alpha, which is where the packed texture keeps it.
+	if (buildData.packedMaskExpression && (buildData.params.packedMasks.detailMaskTex >= 0)){
+		buildData.detailMaskExpression = buildData.packedMaskExpression;
+		return;
+	}
+
+	auto detailTex = buildData.params.detailMaskTex;
+	if (!detailTex)
+		return;
 
-	auto detailTexNode = createTextureExpression(material, detailTex, TEXT("Detail texture"), false);
+	auto detailTexNode = createTextureParameterExpression(material, detailTex, MatParamNames::detailMaskTex, false);
 	if (buildData.mainUv){
 		detailTexNode->Coordinates.Expression = buildData.mainUv;
 	}
@@ -252,11 +323,21 @@ void MaterialBuilder::processOcclusion(UMaterial* material, const JsonMaterial &
 	if (!fingerprint.occlusionTex)
 		return;
 
-	auto occlusionTex = buildData.importer->getTexture(jsonMat.occlusionTex);
-	auto occlusionTexExpr = createTextureExpression(material, occlusionTex, TEXT("Occlusion texture"));
-	UMaterialExpression *occlusionExpr = occlusionTexExpr;
+	UMaterialExpression *occlusionExpr = nullptr;
+	if (buildData.packedMaskExpression && (buildData.params.packedMasks.occlusionTex >= 0)){
+		occlusionExpr = createComponentMask(material, buildData.packedMaskExpression, true, false, false, false);
+	}
+	else if (buildData.params.occlusionTex){
+		auto occlusionTexExpr = createTextureParameterExpression(material, buildData.params.occlusionTex, MatParamNames::occlusionTex);
+		if (buildData.mainUv)
+			occlusionTexExpr->Coordinates.Expression = buildData.mainUv;
+		occlusionExpr = occlusionTexExpr;
+	}
+	if (!occlusionExpr)
+		return;
+
 	if (fingerprint.occlusionIntensity){
-		auto occlusionIntensityParam = createScalarParameterExpression(material, jsonMat.occlusionStrength, TEXT("Occlusion intensity"));
+		auto occlusionIntensityParam = createScalarParameterExpression(material, buildData.params.occlusionStrength, MatParamNames::occlusionStrength);
 
 		auto lerpNode = createExpression<UMaterialExpressionLinearInterpolate>(material);
 		lerpNode->A.Expression = occlusionExpr;
@@ -266,9 +347,6 @@ void MaterialBuilder::processOcclusion(UMaterial* material, const JsonMaterial &
 		occlusionExpr = lerpNode;
 	}
 
-	if (!occlusionExpr)
-		return;
-
 	material->AmbientOcclusion.Expression = occlusionExpr;
 }
 
@@ -278,16 +356,23 @@ void MaterialBuilder::processMetallic(UMaterial* material, const JsonMaterial &j
 
 	UMaterialExpression *metallicExpr = nullptr;
 	if (fingerprint.metallicTex){
-		auto metallicTex = buildData.importer->getTexture(jsonMat.metallicTex);
-		auto texExpr = createTextureExpression(material, metallicTex, TEXT("Metallic (texture)"));
-		if (buildData.mainUv)
-			texExpr->Coordinates.Expression = buildData.mainUv;
-		buildData.metallicTexExpression = texExpr;
-		metallicExpr = texExpr;
+		if (buildData.packedMaskExpression && (buildData.params.packedMasks.metallicTex >= 0)){
+			buildData.metallicTexExpression = buildData.packedMaskExpression;
+			metallicExpr = createComponentMask(material, buildData.packedMaskExpression, false, false, true, false);
+		}
+		else if (buildData.params.metallicTex){
+			auto texExpr = createTextureParameterExpression(material, buildData.params.metallicTex, MatParamNames::metallicTex);
+			if (buildData.mainUv)
+				texExpr->Coordinates.Expression = buildData.mainUv;
+			buildData.metallicTexExpression = texExpr;
+			metallicExpr = texExpr;
+		}
+		//smoothness is in metallic alpha, or in green of the packed texture
+		buildData.smoothTexSource = buildData.metallicTexExpression;
 	}
 
 	if (!metallicExpr){
-		auto metalParam = createScalarParameterExpression(material, jsonMat.metallic, TEXT("Metallic"));
+		auto metalParam = createScalarParameterExpression(material, buildData.params.metallic, MatParamNames::metallic);
 		metallicExpr = metalParam;
 	}
 
@@ -302,9 +387,8 @@ void MaterialBuilder::processSpecular(UMaterial* material, const JsonMaterial &j
 
 	//TODO... remove color if specular is white?
 	//Actually, specular color texture can't be tinted in unity. Which is odd.
-	if (fingerprint.specularTex){
-		auto specTex = buildData.importer->getTexture(jsonMat.specularTex);
-		auto specTexNode = createTextureExpression(material, specTex, TEXT("Specular (texture)"));
+	if (fingerprint.specularTex && buildData.params.specularTex){
+		auto specTexNode = createTextureParameterExpression(material, buildData.params.specularTex, MatParamNames::specularTex);
 		if (buildData.mainUv){
 			specTexNode->Coordinates.Expression = buildData.mainUv;
 		}
@@ -317,9 +401,10 @@ void MaterialBuilder::processSpecular(UMaterial* material, const JsonMaterial &j
 
 		buildData.specularTexExpression = specTexNode;
 		buildData.specularExpression = specTexNode;//mul;
+		buildData.smoothTexSource = specTexNode;
 	}
 	else{
-		auto specColor = createVectorParameterExpression(material, jsonMat.specularColor, TEXT("Specular (color)"));
+		auto specColor = createVectorParameterExpression(material, buildData.params.specularColor, MatParamNames::specularColor);
 		buildData.specularColorExpression = specColor;
 		buildData.specularExpression = specColor;
 	}
@@ -356,14 +441,15 @@ void MaterialBuilder::processSpecular(UMaterial* material, const JsonMaterial &j
 void MaterialBuilder::processRoughness(UMaterial* material, const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, MaterialBuildData &buildData){
 	//Well, unity went ahead and added roughness-based shader, apparently. Sigh. I'll need to look into this later.
 
-	auto constRough = createScalarParameterExpression(material, 1.0f - jsonMat.smoothness, TEXT("Roughness"));
+	auto constRough = createScalarParameterExpression(material, buildData.params.roughness, MatParamNames::roughness);
 	UMaterialExpression *roughExpr = constRough;
 
 	UMaterialExpression *smoothSource = fingerprint.altSmoothnessTexture ? buildData.albedoTexExpression: buildData.smoothTexSource;
 
 	//UMaterialExpression *roughExpression = nullptr;
 	if (smoothSource){
-		auto smoothMask = createComponentMask(material, smoothSource, false, false, false, true);
+		bool packedSmoothness = (smoothSource == buildData.packedMaskExpression);
+		auto smoothMask = createComponentMask(material, smoothSource, false, packedSmoothness, false, !packedSmoothness);
 		auto converter = createExpression<UMaterialExpressionOneMinus>(material);
 		converter->Input.Expression = smoothMask;
 
@@ -391,6 +477,8 @@ void MaterialBuilder::buildMaterial(UMaterial* material, const JsonMaterial &jso
 
 	//detail coordinates, if necessary.
 	processDetailUv(material, jsonMat, fingerprint, buildData);
+	//one sampler for occlusion, smoothness, metallic and detail mask
+	processPackedMasks(material, jsonMat, fingerprint, buildData);
 	//this one creates detail mask
 	processDetailMask(material, jsonMat, fingerprint, buildData);
 	//albedo and albedo detail
@@ -409,6 +497,9 @@ void MaterialBuilder::buildMaterial(UMaterial* material, const JsonMaterial &jso
 	processRoughness(material, jsonMat, fingerprint, buildData);
 	//opacity
 	processOpacity(material, jsonMat, fingerprint, buildData);
+	//unity baked lighting, only on lightmap variants
+	if (buildData.bakedLightmap)
+		processBakedLightmap(material, jsonMat, fingerprint, buildData);
 	//sort this as a grid.
 
 	//arrangeNodesGrid(material, jsonMat, fingerprint, buildData);
@@ -13,6 +13,7 @@
 #include "MaterialExpressionBuilder.h"
 #include "Factories/MaterialInstanceConstantFactoryNew.h"
 #include "Factories/MaterialFactoryNew.h"
+#include "Materials/MaterialExpressionTextureSampleParameter.h"
 #include "AssetRegistryModule.h"
 
 //#include "MaterialUtilities.h"
@@ -49,6 +50,7 @@ UMaterial* MaterialBuilder::importMasterMaterial(const JsonMaterial& jsonMat, Js
 	//stuff
 	//MaterialBuildData buildData(matId, importer);
 	MaterialBuildData buildData(jsonMat.id, importer);
+	buildData.params = MaterialTemplateParams(jsonMat, fingerprint, importer);
 	buildMaterial(material, jsonMat, fingerprint, buildData);
 
 	if (material){
@@ -65,6 +67,44 @@ UMaterial* MaterialBuilder::importMasterMaterial(const JsonMaterial& jsonMat, Js
 	return material;
 }
 
+UMaterial* MaterialBuilder::createTemplateMaterial(const MaterialTemplateKey &key, const JsonMaterial& jsonMat, 
+		const MaterialTemplateParams &params, JsonImporter *importer){
+	MaterialFingerprint fingerprint(jsonMat);
+	auto matName = key.makeName();
+	UE_LOG(JsonLog, Log, TEXT("Creating material template %s for material %d(%s)"), *matName, jsonMat.id, *jsonMat.name);
+	return createMaterial(matName, FString(TEXT("MaterialTemplates/")) + matName, importer, 
+		[&](UMaterial *material){
+			MaterialBuildData buildData(jsonMat.id, importer);
+			buildData.params = params;
+			buildData.bakedLightmap = (key.flags & MaterialTemplateKey::BakedLightmap) != 0;
+			buildMaterial(material, jsonMat, fingerprint, buildData);
+		}
+	);
+}
+
+UMaterialInstanceConstant* MaterialBuilder::createBakedLightmapInstance(const JsonMaterial& jsonMat, UMaterial *templateMaterial, 
+		const MaterialTemplateParams &params, int32 lightmapTexId, JsonImporter *importer){
+	check(templateMaterial);
+	auto instName = FString::Printf(TEXT("%s_Lightmap%d"), *jsonMat.getUnrealMaterialName(), lightmapTexId);
+	return createTemplateInstance(instName, jsonMat, templateMaterial, params, importer, 
+		[&](UMaterialInstanceConstant *newInst){
+			setTexParam(newInst, "bakedLightmap", lightmapTexId, importer);
+		}
+	);
+}
+
+UMaterialInstanceConstant* MaterialBuilder::createTemplateInstance(const FString &name, const JsonMaterial& jsonMat, UMaterial *templateMaterial, 
+		const MaterialTemplateParams &params, JsonImporter *importer, std::function<void(UMaterialInstanceConstant* matInst)> postConfig){
+	check(templateMaterial);
+	return createMaterialInstance(name, &jsonMat.path, templateMaterial, importer, 
+		[&](UMaterialInstanceConstant *newInst){
+			params.applyTo(newInst);
+			if (postConfig)
+				postConfig(newInst);
+		}
+	);
+}
+
 UMaterial* MaterialBuilder::createMaterial(const FString& name, const FString &path, JsonImporter *importer, 
 		MaterialCallbackFunc newCallback, MaterialCallbackFunc existingCallback, MaterialCallbackFunc postEditCallback){
 	FString sanitizedMatName;
@@ -185,7 +225,36 @@ UMaterialInstanceConstant* MaterialBuilder::createMaterialInstance(const FString
 	return matInst;
 }
 
+bool MaterialBuilder::usesPackedMaskTemplate(const JsonMaterial& jsonMat, const JsonImporter *importer) const{
+	check(importer);
+	if (!importer->usesPackedMaskMaterialInstances())
+		return false;
+	MaterialFingerprint fingerprint(jsonMat);
+	return PackedMaskTexture::Sources::fromMaterial(jsonMat, fingerprint).worthPacking();
+}
+
+UMaterialInstanceConstant* MaterialBuilder::importPackedMaskInstance(const JsonMaterial& jsonMat, JsonImporter *importer){
+	check(importer);
+	MaterialFingerprint fingerprint(jsonMat);
+	MaterialTemplateParams params(jsonMat, fingerprint, importer);
+	if (!params.packedMaskTex)
+		return nullptr;
+
+	auto templateMaterial = importer->loadMaterialTemplate(MaterialTemplateKey(jsonMat, fingerprint, params, false), jsonMat, params);
+	if (!templateMaterial)
+		return nullptr;
+
+	return createTemplateInstance(jsonMat.getUnrealMaterialName(), jsonMat, templateMaterial, params, importer);
+}
+
 UMaterialInstanceConstant* MaterialBuilder::importMaterialInstance(const JsonMaterial& jsonMat, JsonImporter *importer){
+	if (usesPackedMaskTemplate(jsonMat, importer)){
+		if (auto packedInst = importPackedMaskInstance(jsonMat, importer))
+			return packedInst;
+		UE_LOG(JsonLog, Warning, TEXT("Could not create packed mask material for %d(%s), using base material. Mask textures used only by generated materials are linear and may not match its samplers"), 
+			jsonMat.id, *jsonMat.name);
+	}
+
 	MaterialFingerprint fingerprint(jsonMat);
 
 	auto unrealName = jsonMat.getUnrealMaterialName();
@@ -327,14 +396,36 @@ bool MaterialBuilder::setTexParams(UMaterialInstanceConstant *matInst,  FStaticP
 	return true;
 }
 
+UTexture* MaterialBuilder::getNeutralSwitchTexture(UMaterialInstanceConstant *matInst, const char *texParamName, 
+		StaticPermutationPlan::NeutralTexture neutral, JsonImporter *importer) const{
+	check(matInst);
+	check(texParamName);
+	check(importer);
+
+	if (neutral == StaticPermutationPlan::NeutralTexture::None)
+		return nullptr;
+	auto parent = matInst->Parent ? matInst->Parent->GetMaterial(): nullptr;
+	if (!parent)
+		return nullptr;
+
+	auto paramName = FName(texParamName);
+	for(auto expression: parent->Expressions){
+		auto texParam = Cast<UMaterialExpressionTextureSampleParameter>(expression);
+		if (!texParam || (texParam->ParameterName != paramName))
+			continue;
+		return importer->loadNeutralTexture(neutral, texParam->SamplerType);
+	}
+	UE_LOG(JsonLog, Warning, TEXT("Could not find texture parameter \"%s\" in material \"%s\""), 
+		*paramName.ToString(), *parent->GetName());
+	return nullptr;
+}
+
 void MaterialBuilder::setupMaterialInstance(UMaterialInstanceConstant *matInst, const JsonMaterial &jsonMat, JsonImporter *importer){
 	if (!matInst){
 		UE_LOG(JsonLog, Warning, TEXT("Mat instance is null!"));
 		return;
 	}
 
-	MaterialFingerprint fingerprint(jsonMat);
-
 	//auto val = matInst->VectorParameterValues.AddDefaulted_GetRef();
 
 	FStaticParameterSet outParams;
@@ -347,90 +438,34 @@ void MaterialBuilder::setupMaterialInstance(UMaterialInstanceConstant *matInst,
 =======================
 */
 
-	//albedo texture and color
 	//albedoColor (c)
 	setVectorParam(matInst, "albedoColor", jsonMat.colorGammaCorrected);
-	//albedoTexEnabled (bool)
-	//albedoTexture (tex2d)
-	setTexParams(matInst, outParams, jsonMat.mainTexture, "albedoTexEnabled", "albedoTexture", importer);
 
-	//main texutre offset
-	//mainTextureTransformEnabled (bool)
-	setStaticSwitch(outParams, "mainTextureTransformEnabled", fingerprint.mainTextureTransform);
 	//mainTexOffset (vec2 as vec4)
 	//mainTexScale(vec2 as vec4)
 	setVectorParam(matInst, "mainTexOffset", jsonMat.mainTextureOffset);
 	setVectorParam(matInst, "mainTexScale", jsonMat.mainTextureScale);
 
-	//altSmoothnessSourceEnabled (bool)
-	setStaticSwitch(outParams, "altSmoothnessSourceEnabled", fingerprint.altSmoothnessTexture);
-
-	//detailAlbedo(tex2d)
-	//detailAlbedoEnabled(bool)
-	setTexParams(matInst, outParams, jsonMat.detailAlbedoTex, "detailAlbedoEnabled", "detailAlbedo", importer);
 	//detailAlbedoOffset(vec2 - as vec4)
 	//detailAlbedoScale (vec2 - as vec4)
 	setVectorParam(matInst, "detailAlbedoScale", jsonMat.detailAlbedoScale);
 	setVectorParam(matInst, "detailAlbedoOffset", jsonMat.detailAlbedoOffset);
 
-	//detailTexTransformEnabled (bool)
-	setStaticSwitch(outParams, "detailTexTransformEnabled", fingerprint.detailTextureTransform);
-
-	//detialMask (tex2d)
-	//detailMaskEnabled (bool)
-	setTexParams(matInst, outParams, jsonMat.detailMaskTex, "detailMaskEnabled", "detialMask", importer);
-
-	//detailNormalEnabled(bool)
-	//detailNormalMap (tex2d)
-	setTexParams(matInst, outParams, jsonMat.detailNormalMapTex, "detailNormalEnabled", "detailNormalMap", importer);
-
-	//detailNormalScaleEnabled (fbool
 	//detailNormalMapScale (float, bumpScale)
-	setStaticSwitch(outParams, "detailNormalScaleEnabled", fingerprint.detailNormalMapScale);
 	setScalarParam(matInst, "detailNormalMapScale", jsonMat.detailNormalMapScale);
 
-	//detailUseUv0 (bool)
-	setStaticSwitch(outParams, "detailUseUv0", fingerprint.secondaryUv == 0);
-	//detailUseUv1 (bool)
-	setStaticSwitch(outParams, "detailUseUv1", fingerprint.secondaryUv == 1);
-	//detailUseUv2 (bool)
-	setStaticSwitch(outParams, "detailUseUv2", fingerprint.secondaryUv == 2);
-	//detailUseUv3 (bool)
-	setStaticSwitch(outParams, "detailUseUv3", fingerprint.secondaryUv == 3);
-
-	//emissionEnabled(bool)
-	setStaticSwitch(outParams, "emissionEnabled", fingerprint.emissionEnabled);
 	//emissiveColor(FlinearColor)
 	setVectorParam(matInst, "emissiveColor", jsonMat.emissionColor);
-	//emissionTexEnabled(bool)
-	//emissiveTexture (tex2d)
-	setTexParams(matInst, outParams, jsonMat.emissionTex, "emissionTexEnabled", "emissiveTexture", importer);
 
 	//metallic (float)
 	setScalarParam(matInst, "metallic", jsonMat.metallic);
 
-	//metallicTex (tex2d)
-	//metallicTexEnabled (bool)
-	setTexParams(matInst, outParams, jsonMat.metallicTex, "metallicTexEnabled", "metallicTex", importer);
-
-	//normalMapTexEnabled (bool)
-	//normalMapTexture (tex2d)
-	setTexParams(matInst, outParams, jsonMat.normalMapTex, "normalMapTexEnabled", "normalMapTexture", importer);
-
 	//normalMapScale (float, bumpScale)
-	//normalMapScaleEnabled (bool)
-	setStaticSwitch(outParams, "normalMapScaleEnabled", fingerprint.normalMapIntensity);
 	setScalarParam(matInst, "normalMapScale", jsonMat.bumpScale);
 
-	//occlusionScaleEnabled(float)
 	//occlusionScale (float)
-	setStaticSwitch(outParams, "occlusionScaleEnabled", fingerprint.occlusionIntensity);
 	setScalarParam(matInst, "occlusionScale", jsonMat.occlusionStrength);
 
-	//occlusionTexEnabled (bool)
-	//occlusionTex (tex2d)
-	setTexParams(matInst, outParams, jsonMat.occlusionTex, "occlusionTexEnabled", "occlusionTex", importer);
-
 	//roughness (float)
 	setScalarParam(matInst, "roughness", 1.0f - jsonMat.smoothness);//hmm...
 
@@ -440,20 +475,29 @@ void MaterialBuilder::setupMaterialInstance(UMaterialInstanceConstant *matInst,
 	//specularColor (FlinearColor)
 	setVectorParam(matInst, "specularColor", jsonMat.specularColorGammaCorrected);//hmm...
 
-	//specularTexEnabled ( bool )
-	//specularTex (tex2d)
-	setTexParams(matInst, outParams, jsonMat.specularTex, "specularTexEnabled", "specularTex", importer);
-
-	//specularWorkflowEnabled (bool, specularMode)
-	setStaticSwitch(outParams, "specularWorkflowEnabled", fingerprint.specularModel);
-
-	//transparencyEnabled (bool)
-	//setStaticSwitch(outParams, "transparencyEnabled", jsonMat.isTransparentQueue() || jsonMat.isAlphaTestQueue());//fingerprint.isAlphaBlendMode());
-	//setStaticSwitch(outParams, "transparencyEnabled", jsonMat.needsTransparencyFlag());//fingerprint.isAlphaBlendMode());
-	setStaticSwitch(outParams, "transparencyEnabled", jsonMat.heuristicNeedsTransparentFlag());//fingerprint.isAlphaBlendMode());
-
-	//useOpacityMask (bool, switch on for cutout mode)
-	setStaticSwitch(outParams, "useOpacityMask", jsonMat.isAlphaTestQueue());//fingerprint.isAlphaTestMode());
+	/*
+	Static switches. The permutation plan may turn on switches the material doesn't need to share a permutation
+	with other materials; scale and transform parameters are already neutral then, missing textures get a neutral texture.
+	*/
+	auto sourceSwitches = StaticPermutationPlan::makeSwitches(jsonMat, importer);
+	auto switches = importer->getStaticPermutationPlan().resolve(jsonMat.id, sourceSwitches);
+	for(int32 i = 0; i < StaticPermutationPlan::NumSwitches; i++){
+		const auto &info = StaticPermutationPlan::getSwitchInfo(i);
+		bool value = (switches & (1u << i)) != 0;
+		if (info.texParamName){
+			auto tex = importer->getTexture(StaticPermutationPlan::getSwitchTexture(jsonMat, i));
+			if (!tex && value)
+				tex = getNeutralSwitchTexture(matInst, info.texParamName, info.neutral, importer);
+			if (!tex && value){
+				UE_LOG(JsonLog, Warning, TEXT("No neutral texture for \"%s\" of material %d(%s), leaving switch off"),
+					ANSI_TO_TCHAR(info.switchName), jsonMat.id, *jsonMat.name);
+				value = false;
+			}
+			if (tex)
+				setTexParam(matInst, info.texParamName, tex);
+		}
+		setStaticSwitch(outParams, info.switchName, value);
+	}
 
 	matInst->UpdateStaticPermutation(outParams);
 	//matInst->InitStaticPermutation();
@@ -6,6 +6,9 @@
 #include "AssetRegistryModule.h"
 #include "UnrealUtilities.h"
 #include "Factories/MaterialFactoryNew.h"
+#ifdef EXODUS_UE_VER_4_25_GE
+#include "Engine/Texture2DArray.h"
+#endif
 
 UMaterialExpression* createTerrainLayerCoords(UMaterial *material, const JsonTerrain &terr, const JsonTerrainData &terrData
 	, const FVector2D& splatSize, const FVector2D& splatOffset, const FIntPoint &terrainVertSize,  const TCHAR* text = 0){
@@ -60,6 +63,7 @@ UMaterialExpression* createTerrainLayerCoords(UMaterial *material, const JsonTer
 }
 
 UMaterialExpression* createLayerBlending(UMaterial* material, bool needSeparateBlend, const JsonTerrainData &terrData
+	, const IntArray &splatLayers
 	, std::function<UMaterialExpression*(UMaterial* material, int index, const JsonSplatPrototype &splat)> channelFunc
 	, const TCHAR* blendName = 0){
 	using namespace MaterialTools;
@@ -68,17 +72,17 @@ UMaterialExpression* createLayerBlending(UMaterial* material, bool needSeparateB
 		return nullptr;
 	}
 
-	if (terrData.splatPrototypes.Num() <= 0){
+	if (splatLayers.Num() <= 0){
 		UE_LOG(JsonLogTerrain, Error, TEXT("No splats on terrain \"%s\", material generation won't proceed far"), *terrData.name);
 		return nullptr;
 	}
 
 	if (!needSeparateBlend){
-		return channelFunc(material, 0, terrData.splatPrototypes[0]);
+		return channelFunc(material, splatLayers[0], terrData.splatPrototypes[splatLayers[0]]);
 	}
 
 	auto blendExpr = createExpression<UMaterialExpressionLandscapeLayerBlend>(material, blendName);
-	for(int layerIndex = 0; layerIndex < terrData.splatPrototypes.Num(); layerIndex++){
+	for(auto layerIndex: splatLayers){
 		const auto &srcSplat = terrData.splatPrototypes[layerIndex];
 		auto layerName = terrData.getLayerName(layerIndex);
 
@@ -104,6 +108,9 @@ UMaterialExpression* createDetailControl(UMaterial* material, const TerrainBuild
 		return nullptr;
 
 	check(terrainBuilder->grassTypes.Num() == terrainBuilder->terrainData.detailPrototypes.Num());
+	//All detail layers may have been dropped or converted to instances
+	if (!terrainBuilder->grassTypes.ContainsByPredicate([](const ULandscapeGrassType *arg){return arg != nullptr;}))
+		return nullptr;
 
 	auto numDetailLayers = terrData.detailPrototypes.Num();
 	auto grassControl = createExpression<UMaterialExpressionLandscapeGrassOutput>(material, TEXT("Grass control"));
@@ -115,13 +122,18 @@ UMaterialExpression* createDetailControl(UMaterial* material, const TerrainBuild
 	auto zeroConst = createExpression<UMaterialExpressionConstant>(material, TEXT("Zero"));
 	zeroConst->R = 0.0f;
 
+	int dstGrassIndex = 0;
 	for(int i = 0; i < numDetailLayers; i++){
+		//Empty detail layers were not imported and have no grass type.
+		if (!terrainBuilder->grassTypes[i])
+			continue;
 		auto layerName = terrData.getGrassLayerName(i);
 
 		auto &grassTypes = grassControl->GrassTypes;
 		//what the hell.
 		//auto& dstGrass = grassTypes.Num() > 0 ? grassTypes[0]: grassTypes.AddDefaulted_GetRef();
-		auto& dstGrass = (grassTypes.Num() >= (i + 1)) ? grassTypes[i]: grassTypes.AddDefaulted_GetRef();
+		auto grassIndex = dstGrassIndex++;
+		auto& dstGrass = (grassTypes.Num() >= (grassIndex + 1)) ? grassTypes[grassIndex]: grassTypes.AddDefaulted_GetRef();
 		dstGrass.Name = *layerName;
 		dstGrass.GrassType = terrainBuilder->grassTypes[i];
 
@@ -140,6 +152,66 @@ UMaterialExpression* createDetailControl(UMaterial* material, const TerrainBuild
 	return grassControl;
 }
 
+#ifdef EXODUS_UE_VER_4_25_GE
+/*
+Packs splat textures of the used layers into a texture array, slices follow the order of splatLayers.
+Returns null when a layer has no texture or the textures differ in size or format.
+*/
+UTexture2DArray* createSplatTextureArray(const TerrainBuilder *terrainBuilder, const IntArray &splatLayers, 
+		bool normalMaps, const FString &terrainDataPath){
+	using namespace UnrealUtilities;
+	const auto &terrData = terrainBuilder->terrainData;
+	const auto *importer = terrainBuilder->getImporter();
+
+	TArray<UTexture2D*> sourceTextures;
+	for(auto layerIndex: splatLayers){
+		const auto &splat = terrData.splatPrototypes[layerIndex];
+		auto texId = normalMaps ? splat.normalMapId: splat.textureId;
+		auto tex = Cast<UTexture2D>(importer->getTexture(texId));
+		if (!tex){
+			UE_LOG(JsonLogTerrain, Log, TEXT("Splat layer %d of terrain \"%s\" has no texture %d, texture array won't be used"), 
+				layerIndex, *terrData.name, texId);
+			return nullptr;
+		}
+		if (sourceTextures.Num() > 0){
+			const auto &first = sourceTextures[0]->Source;
+			if ((tex->Source.GetSizeX() != first.GetSizeX()) || (tex->Source.GetSizeY() != first.GetSizeY()) 
+					|| (tex->Source.GetFormat() != first.GetFormat())){
+				UE_LOG(JsonLogTerrain, Log, TEXT("Texture \"%s\" of splat layer %d differs in size or format, texture array won't be used"), 
+					*tex->GetPathName(), layerIndex);
+				return nullptr;
+			}
+		}
+		sourceTextures.Add(tex);
+	}
+	if (sourceTextures.Num() == 0)
+		return nullptr;
+
+	auto arrayName = terrData.name + (normalMaps ? TEXT("_NormalArray"): TEXT("_ColorArray"));
+	auto result = createAssetObject<UTexture2DArray>(arrayName, &terrainDataPath, importer, 
+		[&](UTexture2DArray *texArray){
+			texArray->SRGB = sourceTextures[0]->SRGB;
+			texArray->CompressionSettings = sourceTextures[0]->CompressionSettings;
+			texArray->SourceTextures = sourceTextures;
+			texArray->UpdateSourceFromSourceTextures(true);
+		}, RF_Standalone|RF_Public
+	);
+	UE_LOG(JsonLogTerrain, Log, TEXT("Created %s texture array with %d slices for terrain \"%s\""), 
+		normalMaps ? TEXT("normal"): TEXT("color"), sourceTextures.Num(), *terrData.name);
+	return result;
+}
+#endif
+
+UMaterialExpression* createTextureArraySample(UMaterial *material, UTexture *texArray, UMaterialExpression *uvCoords, 
+		int slice, bool normalMap){
+	using namespace MaterialTools;
+	auto sliceConst = createConstantExpression(material, (float)slice, nullptr);
+	auto coords = createAppendVectorExpression(material, uvCoords, sliceConst);
+	auto texExpr = createTextureExpression(material, texArray, 0, normalMap);
+	texExpr->Coordinates.Expression = coords;
+	return texExpr;
+}
+
 void MaterialBuilder::buildTerrainMaterial(UMaterial* material, 
 		const TerrainBuilder *terrainBuilder,
 		const FIntPoint &terrainVertSize, const FString &terrainDataPath){
@@ -150,6 +222,7 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 	material->BlendMode = BLEND_Masked;
 
 	const auto &terrData = terrainBuilder->terrainData;
+	const auto &splatLayers = terrainBuilder->layerUsage.splatLayers;
 
 	bool needColorBlend = false;
 	bool needNormalBlend = false;
@@ -163,8 +236,8 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 	float defaultMetallic = 0.0f, defaultSmoothness = 0.0f;
 	FLinearColor defaultSpecular = FLinearColor::White;
 
-	for(int i = 0; i < terrData.splatPrototypes.Num(); i++){
-		auto& cur = terrData.splatPrototypes[i];
+	for(int i = 0; i < splatLayers.Num(); i++){
+		auto& cur = terrData.splatPrototypes[splatLayers[i]];
 		if (i == 0){
 			defaultMetallic = cur.metallic;
 			defaultSpecular = cur.specular;
@@ -176,32 +249,51 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 			needMetallicBlend = needMetallicBlend || (defaultMetallic != cur.metallic);
 			needSpecularBlend = needSpecularBlend || (defaultSpecular != cur.specular);
 			needSmoothnessBlend = needSmoothnessBlend || (defaultSmoothness != cur.smoothness);
-			needUvScales = needUvScales || (defaultTileSize != cur.tileSize) || (defaultTileOffset != cur.tileSize);
+			needUvScales = needUvScales || (defaultTileSize != cur.tileSize) || (defaultTileOffset != cur.tileOffset);
 		}
 		needColorBlend = needColorBlend || (cur.textureId >= 0);
 		needNormalBlend = needNormalBlend || (cur.normalMapId >= 0);
 	}
+	//A single remaining layer is sampled directly without a blend node.
+	if (splatLayers.Num() == 1)
+		needColorBlend = false;
 
+	//Indexed by source splat prototype, dropped layers get no coordinates.
 	TArray<UMaterialExpression*> layerUvCoords;
+	layerUvCoords.SetNumZeroed(terrData.splatPrototypes.Num());
 	const auto &terr = terrainBuilder->jsonTerrain;
 	if (needUvScales){
-		for(int i = 0; i < terrData.splatPrototypes.Num(); i++){
+		for(auto i: splatLayers){
 			const auto& src = terrData.splatPrototypes[i];
 			auto coordName = FString::Printf(TEXT("uv coords #%d: %s"), i, *terrData.getLayerName(i));
 			auto curExpr = createTerrainLayerCoords(material, terr, terrData, src.tileSize, src.tileOffset, terrainVertSize, TEXT("uv coords"));
-			layerUvCoords.Add(curExpr);
+			layerUvCoords[i] = curExpr;
 		}
 	}
 	else{
 		auto defaultExpr = createTerrainLayerCoords(material, terr, terrData, defaultTileSize, defaultTileOffset, terrainVertSize, TEXT("default uv coords"));
-		for(int i = 0; i < terrData.splatPrototypes.Num(); i++){
-			layerUvCoords.Add(defaultExpr);
+		for(auto i: splatLayers){
+			layerUvCoords[i] = defaultExpr;
 		}
 	}
 
 	auto* importer = terrainBuilder->getImporter();
-	auto* colorBlendExpr = createLayerBlending(material, needColorBlend, terrData, 
+
+	//Every layer samples the same array, so the sampler count doesn't grow with the number of layers.
+	UTexture *colorArray = nullptr, *normalArray = nullptr;
+#ifdef EXODUS_UE_VER_4_25_GE
+	const auto &importSettings = terrainBuilder->settings;
+	if ((importSettings.textureArrayMinLayers > 0) && (splatLayers.Num() >= importSettings.textureArrayMinLayers)){
+		colorArray = createSplatTextureArray(terrainBuilder, splatLayers, false, terrainDataPath);
+		if (needNormalBlend)
+			normalArray = createSplatTextureArray(terrainBuilder, splatLayers, true, terrainDataPath);
+	}
+#endif
+
+	auto* colorBlendExpr = createLayerBlending(material, needColorBlend, terrData, splatLayers, 
 		[&](UMaterial* mat, int layerIndex, const JsonSplatPrototype& srcSplat) -> UMaterialExpression*{
+			if (colorArray)
+				return createTextureArraySample(material, colorArray, layerUvCoords[layerIndex], splatLayers.IndexOfByKey(layerIndex), false);
 			auto* colorTex = importer->getTexture(srcSplat.textureId);
 			if (colorTex){
 				auto texExpr = createTextureExpression(material, colorTex, 0);
@@ -218,8 +310,10 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 	material->BaseColor.Expression = colorBlendExpr;
 
 	if (needNormalBlend){
-		auto* normBlendExpr = createLayerBlending(material, needNormalBlend, terrData,
+		auto* normBlendExpr = createLayerBlending(material, splatLayers.Num() > 1, terrData, splatLayers,
 			[&](UMaterial* mat, int layerIndex, const JsonSplatPrototype& srcSplat) -> UMaterialExpression*{
+				if (normalArray)
+					return createTextureArraySample(material, normalArray, layerUvCoords[layerIndex], splatLayers.IndexOfByKey(layerIndex), true);
 				auto* normTex = importer->getTexture(srcSplat.normalMapId);
 
 				if (normTex){
@@ -237,7 +331,7 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 		material->Normal.Expression = normBlendExpr;
 	}
 
-	auto metallicBlendExpr = createLayerBlending(material, needMetallicBlend, terrData,
+	auto metallicBlendExpr = createLayerBlending(material, needMetallicBlend, terrData, splatLayers,
 		[&](UMaterial* mat, int layerIndex, const JsonSplatPrototype& srcSplat) -> UMaterialExpression*{
 			auto name = FString::Printf(TEXT("Metallic for layer %d(%s)"), layerIndex, *terrData.getLayerName(layerIndex));
 			auto result = createConstantExpression(material, srcSplat.metallic, *name);
@@ -246,7 +340,7 @@ void MaterialBuilder::buildTerrainMaterial(UMaterial* material,
 	);
 	material->Metallic.Expression = metallicBlendExpr;
 
-	auto roughnessExpr = createLayerBlending(material, needSmoothnessBlend, terrData,
+	auto roughnessExpr = createLayerBlending(material, needSmoothnessBlend, terrData, splatLayers,
 		[&](UMaterial* mat, int layerIndex, const JsonSplatPrototype& srcSplat) -> UMaterialExpression*{
 			auto name = FString::Printf(TEXT("Roughness for layer %d(%s)"), layerIndex, *terrData.getLayerName(layerIndex));
 			auto result = createConstantExpression(material, 1.0f - srcSplat.smoothness, 0);
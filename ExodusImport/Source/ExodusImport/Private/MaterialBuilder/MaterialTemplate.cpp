@@ -0,0 +1,143 @@
+#include "JsonImportPrivatePCH.h"
+#include "MaterialTemplate.h"
+
+#include "JsonImporter.h"
+#include "MatParamNames.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Materials/MaterialExpressionTextureBase.h"
+
+MaterialTemplateParams::MaterialTemplateParams(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, JsonImporter *importer){
+	check(importer);
+
+	mainUvScale = jsonMat.mainTextureScale;
+	mainUvOffset = jsonMat.mainTextureOffset;
+	detailUvScale = jsonMat.detailAlbedoScale;
+	detailUvOffset = jsonMat.detailAlbedoOffset;
+
+	albedoColor = jsonMat.colorGammaCorrected;
+	emissiveColor = jsonMat.emissionColor;
+	specularColor = jsonMat.specularColor;
+
+	bumpScale = jsonMat.bumpScale;
+	detailNormalScale = jsonMat.detailNormalMapScale;
+	occlusionStrength = jsonMat.occlusionStrength;
+	metallic = jsonMat.metallic;
+	roughness = 1.0f - jsonMat.smoothness;
+
+	if (importer->usesPackedMaskTextures()){
+		auto sources = PackedMaskTexture::Sources::fromMaterial(jsonMat, fingerprint);
+		if (sources.worthPacking()){
+			packedMaskTex = importer->loadPackedMaskTexture(sources, jsonMat.path);
+			if (packedMaskTex){
+				packedMasks = sources;
+			}
+			else{
+				UE_LOG(JsonLog, Warning, TEXT("Could not pack mask textures of material %d(%s), sampling them separately"), jsonMat.id, *jsonMat.name);
+			}
+		}
+	}
+
+	if (fingerprint.albedoTex)
+		albedoTex = importer->getTexture(jsonMat.albedoTex);
+	if (fingerprint.detailAlbedoTex)
+		detailAlbedoTex = importer->getTexture(jsonMat.detailAlbedoTex);
+	if (fingerprint.normalmapTex)
+		normalTex = importer->getTexture(jsonMat.normalMapTex);
+	if (fingerprint.detailNormalTex)
+		detailNormalTex = importer->getTexture(jsonMat.detailNormalMapTex);
+	if (fingerprint.emissionEnabled)
+		emissiveTex = importer->getTexture(jsonMat.emissionTex);
+	if (fingerprint.detailMaskTex && fingerprint.hasDetailMaps() && (packedMasks.detailMaskTex < 0))
+		detailMaskTex = importer->getTexture(jsonMat.detailMaskTex);
+	if (fingerprint.occlusionTex && (packedMasks.occlusionTex < 0))
+		occlusionTex = importer->getTexture(jsonMat.occlusionTex);
+	if (fingerprint.metallicTex && !fingerprint.specularModel && (packedMasks.metallicTex < 0))
+		metallicTex = importer->getTexture(jsonMat.metallicTex);
+	if (fingerprint.specularTex && fingerprint.specularModel)
+		specularTex = importer->getTexture(jsonMat.specularTex);
+}
+
+void MaterialTemplateParams::applyTo(UMaterialInstanceConstant *matInst) const{
+	check(matInst);
+	namespace Names = MatParamNames;
+
+	auto setScalar = [&](const TCHAR *name, float val){
+		matInst->SetScalarParameterValueEditorOnly(FMaterialParameterInfo(FName(name)), val);
+	};
+	auto setVector = [&](const TCHAR *name, const FLinearColor &val){
+		matInst->SetVectorParameterValueEditorOnly(FMaterialParameterInfo(FName(name)), val);
+	};
+	auto setVector2 = [&](const TCHAR *name, const FVector2D &val){
+		setVector(name, FLinearColor(val.X, val.Y, 0.0f, 1.0f));
+	};
+	auto setTexture = [&](const TCHAR *name, UTexture *tex){
+		if (tex)
+			matInst->SetTextureParameterValueEditorOnly(FMaterialParameterInfo(FName(name)), tex);
+	};
+
+	setVector2(Names::mainUvScale, mainUvScale);
+	setVector2(Names::mainUvOffset, mainUvOffset);
+	setVector2(Names::detailUvScale, detailUvScale);
+	setVector2(Names::detailUvOffset, detailUvOffset);
+
+	setVector(Names::albedoColor, albedoColor);
+	setVector(Names::emissiveColor, emissiveColor);
+	setVector(Names::specularColor, specularColor);
+
+	setScalar(Names::bumpScale, bumpScale);
+	setScalar(Names::detailNormalScale, detailNormalScale);
+	setScalar(Names::occlusionStrength, occlusionStrength);
+	setScalar(Names::metallic, metallic);
+	setScalar(Names::roughness, roughness);
+
+	setTexture(Names::albedoTex, albedoTex);
+	setTexture(Names::detailAlbedoTex, detailAlbedoTex);
+	setTexture(Names::normalTex, normalTex);
+	setTexture(Names::detailNormalTex, detailNormalTex);
+	setTexture(Names::emissiveTex, emissiveTex);
+	setTexture(Names::detailMaskTex, detailMaskTex);
+	setTexture(Names::occlusionTex, occlusionTex);
+	setTexture(Names::metallicTex, metallicTex);
+	setTexture(Names::specularTex, specularTex);
+	setTexture(Names::packedMaskTex, packedMaskTex);
+}
+
+MaterialTemplateKey::MaterialTemplateKey(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint,
+		const MaterialTemplateParams &params, bool bakedLightmap){
+	fingerprintId = fingerprint.id;
+
+	if (bakedLightmap)
+		flags |= BakedLightmap;
+	if (jsonMat.isTransparentQueue())
+		flags |= TransparentQueue;
+	if (jsonMat.isAlphaTestQueue())
+		flags |= AlphaTestQueue;
+	if (jsonMat.isGeomQueue())
+		flags |= GeomQueue;
+	if (params.packedMasks.occlusionTex >= 0)
+		flags |= PackedOcclusion;
+	if (params.packedMasks.metallicTex >= 0)
+		flags |= PackedMetallic;
+	if (params.packedMasks.detailMaskTex >= 0)
+		flags |= PackedDetailMask;
+
+	//Texture parameters only accept textures matching the sampler type the template was compiled with.
+	const int32 numSlots = 10;
+	const UTexture* slots[numSlots] = {
+		params.albedoTex, params.detailAlbedoTex, params.normalTex, params.detailNormalTex, params.emissiveTex,
+		params.detailMaskTex, params.occlusionTex, params.metallicTex, params.specularTex, params.packedMaskTex
+	};
+	static_assert(numSlots * 4 <= 64, "Too many texture slots in material template key");
+	for(int32 i = 0; i < numSlots; i++){
+		if (!slots[i])
+			continue;
+		uint64 samplerType = (uint64)UMaterialExpressionTextureBase::GetSamplerTypeForTexture(slots[i]) + 1;
+		samplerTypes |= (samplerType & 0xF) << (i * 4);
+	}
+}
+
+FString MaterialTemplateKey::makeName() const{
+	MaterialFingerprint fingerprint;
+	fingerprint.id = fingerprintId;
+	return FString::Printf(TEXT("%s_Template%02x_%010llx"), *fingerprint.getMatName(), flags, samplerTypes);
+}
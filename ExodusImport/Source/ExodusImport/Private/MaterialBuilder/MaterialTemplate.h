@@ -0,0 +1,85 @@
+#pragma once
+#include "JsonTypes.h"
+#include "MaterialBuilder/MaterialFingerprint.h"
+#include "MaterialBuilder/PackedMaskTexture.h"
+
+class JsonImporter;
+class JsonMaterial;
+class UTexture;
+class UMaterialInstanceConstant;
+
+/*
+Values a code generated material takes from its json material. Graph stages use them as parameter defaults,
+and instances of a shared template graph receive them as parameter overrides (see MatParamNames).
+*/
+class MaterialTemplateParams{
+public:
+	FVector2D mainUvScale = FVector2D(1.0f, 1.0f);
+	FVector2D mainUvOffset = FVector2D(0.0f, 0.0f);
+	FVector2D detailUvScale = FVector2D(1.0f, 1.0f);
+	FVector2D detailUvOffset = FVector2D(0.0f, 0.0f);
+
+	FLinearColor albedoColor = FLinearColor::White;
+	FLinearColor emissiveColor = FLinearColor::Black;
+	FLinearColor specularColor = FLinearColor::Black;
+
+	float bumpScale = 1.0f;
+	float detailNormalScale = 1.0f;
+	float occlusionStrength = 1.0f;
+	float metallic = 0.0f;
+	float roughness = 0.5f;
+
+	UTexture *albedoTex = nullptr;
+	UTexture *detailAlbedoTex = nullptr;
+	UTexture *normalTex = nullptr;
+	UTexture *detailNormalTex = nullptr;
+	UTexture *emissiveTex = nullptr;
+	UTexture *detailMaskTex = nullptr;
+	UTexture *occlusionTex = nullptr;
+	UTexture *metallicTex = nullptr;
+	UTexture *specularTex = nullptr;
+
+	//Sources that were packed are sampled from packedMaskTex, their separate textures stay null.
+	UTexture *packedMaskTex = nullptr;
+	PackedMaskTexture::Sources packedMasks;
+
+	void applyTo(UMaterialInstanceConstant *matInst) const;
+
+	MaterialTemplateParams() = default;
+	MaterialTemplateParams(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, JsonImporter *importer);
+};
+
+/*
+Everything that changes the structure of a generated graph: the fingerprint, blend mode, lightmap variant,
+packed channels and sampler types of the textures. Materials with equal keys share one template graph.
+*/
+class MaterialTemplateKey{
+public:
+	enum Flags: uint32{
+		BakedLightmap = 1 << 0,
+		TransparentQueue = 1 << 1,
+		AlphaTestQueue = 1 << 2,
+		GeomQueue = 1 << 3,
+		PackedOcclusion = 1 << 4,
+		PackedMetallic = 1 << 5,
+		PackedDetailMask = 1 << 6
+	};
+
+	MaterialFingerprintId fingerprintId = 0;
+	uint32 flags = 0;
+	//4 bits per texture slot, 0 for missing texture, sampler type + 1 otherwise
+	uint64 samplerTypes = 0;
+
+	FString makeName() const;
+
+	bool operator==(const MaterialTemplateKey &other) const{
+		return (fingerprintId == other.fingerprintId) && (flags == other.flags) && (samplerTypes == other.samplerTypes);
+	}
+
+	MaterialTemplateKey() = default;
+	MaterialTemplateKey(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint, const MaterialTemplateParams &params, bool bakedLightmap);
+};
+
+inline uint32 GetTypeHash(const MaterialTemplateKey &key){
+	return HashCombine(HashCombine(GetTypeHash(key.fingerprintId), GetTypeHash(key.flags)), GetTypeHash(key.samplerTypes));
+}
@@ -212,7 +212,11 @@ UMaterialExpressionTextureSample* MaterialTools::createTextureExpression(UMateri
 		UE_LOG(JsonLog, Warning, TEXT("Texture not found"));
 	}
 	result = NewObject<UMaterialExpressionTextureSample>(material);
-	result->SamplerType = normalMap ? SAMPLERTYPE_Normal: SAMPLERTYPE_Color;
+	//Sampler type has to match texture compression and srgb, or the material will not compile.
+	if (normalMap)
+		result->SamplerType = SAMPLERTYPE_Normal;
+	else
+		result->SamplerType = unrealTex ? UMaterialExpressionTextureBase::GetSamplerTypeForTexture(unrealTex): SAMPLERTYPE_Color;
 	material->Expressions.Add(result);
 	result->Texture = unrealTex;
 
@@ -224,6 +228,21 @@ UMaterialExpressionTextureSample* MaterialTools::createTextureExpression(UMateri
 	return result;
 }
 
+UMaterialExpressionTextureSampleParameter2D* MaterialTools::createTextureParameterExpression(UMaterial *material, UTexture * unrealTex, const TCHAR* paramName, bool normalMap){
+	check(paramName);
+	if (!unrealTex){
+		UE_LOG(JsonLog, Warning, TEXT("Texture not found for parameter %s"), paramName);
+	}
+	auto result = createExpression<UMaterialExpressionTextureSampleParameter2D>(material, paramName);
+	result->ParameterName = paramName;
+	if (normalMap)
+		result->SamplerType = SAMPLERTYPE_Normal;
+	else
+		result->SamplerType = unrealTex ? UMaterialExpressionTextureBase::GetSamplerTypeForTexture(unrealTex): SAMPLERTYPE_Color;
+	result->Texture = unrealTex;
+	return result;
+}
+
 UMaterialExpression* MaterialTools::createMaterialInputMultiply(UMaterial *material, UTexture *texture, 
 		const FLinearColor *matColor, FExpressionInput &matInput, 
 		const TCHAR* texParamName, const TCHAR* vecParamName,
@@ -4,6 +4,7 @@
 
 #include "Materials/Material.h"
 #include "Materials/MaterialExpressionTextureSample.h"
+#include "Materials/MaterialExpressionTextureSampleParameter2D.h"
 #include "Materials/MaterialExpressionSubtract.h"
 #include "Materials/MaterialExpressionMultiply.h"
 #include "Materials/MaterialExpressionAdd.h"
@@ -58,6 +59,8 @@ namespace MaterialTools{
 
 	UMaterialExpression* createMaterialSingleInput(UMaterial *material, float value, FExpressionInput &matInput, const TCHAR* inputName);
 	UMaterialExpressionTextureSample *createTextureExpression(UMaterial *material, UTexture *texture, const TCHAR* inputName, bool normalMap = false);
+	//Same as createTextureExpression, but the texture can be overridden by material instances.
+	UMaterialExpressionTextureSampleParameter2D *createTextureParameterExpression(UMaterial *material, UTexture *texture, const TCHAR* paramName, bool normalMap = false);
 	UMaterialExpressionVectorParameter *createVectorParameterExpression(UMaterial *material, FLinearColor color, const TCHAR* inputName);
 
 	UMaterialExpressionScalarParameter *createScalarParameterExpression(UMaterial *material, float val, const TCHAR* inputName);
@@ -0,0 +1,182 @@
+#include "JsonImportPrivatePCH.h"
+#include "PackedMaskTexture.h"
+
+#include "JsonImporter.h"
+#include "MaterialFingerprint.h"
+#include "UnrealUtilities.h"
+#include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
+
+using namespace UnrealUtilities;
+
+PackedMaskTexture::Sources PackedMaskTexture::Sources::fromMaterial(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint){
+	Sources result;
+	if (fingerprint.occlusionTex)
+		result.occlusionTex = jsonMat.occlusionTex;
+	//Specular model samples its specular texture for color anyway, so its smoothness stays there.
+	if (fingerprint.metallicTex && !fingerprint.specularModel)
+		result.metallicTex = jsonMat.metallicTex;
+	if (fingerprint.detailMaskTex && fingerprint.hasDetailMaps())
+		result.detailMaskTex = jsonMat.detailMaskTex;
+	return result;
+}
+
+int32 PackedMaskTexture::Sources::getNumDistinctTextures() const{
+	TArray<JsonTextureId, TInlineAllocator<3>> ids;
+	for(auto cur: {occlusionTex, metallicTex, detailMaskTex}){
+		if (cur >= 0)
+			ids.AddUnique(cur);
+	}
+	return ids.Num();
+}
+
+FString PackedMaskTexture::Sources::makeName() const{
+	return FString::Printf(TEXT("PackedMasks_o%d_m%d_d%d"), occlusionTex, metallicTex, detailMaskTex);
+}
+
+/*
+Source art of an imported texture, converted to 8 bit bgra.
+*/
+struct PackSourceImage{
+	int32 width = 0;
+	int32 height = 0;
+	TArray<FColor> pixels;
+
+	bool load(UTexture2D *texture);
+	FColor sample(int32 dstX, int32 dstY, int32 dstWidth, int32 dstHeight) const;
+};
+
+bool PackSourceImage::load(UTexture2D *texture){
+	check(texture);
+	auto &source = texture->Source;
+	if (!source.IsValid())
+		return false;
+
+	auto format = source.GetFormat();
+	if ((format != TSF_BGRA8) && (format != TSF_G8) && (format != TSF_RGBA16))
+		return false;
+
+	width = source.GetSizeX();
+	height = source.GetSizeY();
+	auto numPixels = width * height;
+	if (numPixels <= 0)
+		return false;
+
+	const uint8 *data = source.LockMip(0);
+	if (!data)
+		return false;
+
+	pixels.SetNumUninitialized(numPixels);
+	if (format == TSF_BGRA8){
+		FMemory::Memcpy(pixels.GetData(), data, numPixels * sizeof(FColor));
+	}
+	else if (format == TSF_G8){
+		for(int32 i = 0; i < numPixels; i++)
+			pixels[i] = FColor(data[i], data[i], data[i], 255);
+	}
+	else{
+		const uint16 *data16 = (const uint16*)data;
+		for(int32 i = 0; i < numPixels; i++){
+			const auto *src = data16 + i * 4;
+			pixels[i] = FColor(src[0] >> 8, src[1] >> 8, src[2] >> 8, src[3] >> 8);
+		}
+	}
+	source.UnlockMip(0);
+
+	//Samplers decode srgb textures, the packed texture is linear. Decoding here keeps packed values equal to unpacked samples.
+	if (texture->SRGB){
+		for(auto &pixel: pixels)
+			pixel = FLinearColor(pixel).QuantizeRound();
+	}
+	return true;
+}
+
+FColor PackSourceImage::sample(int32 dstX, int32 dstY, int32 dstWidth, int32 dstHeight) const{
+	if ((dstWidth == width) && (dstHeight == height))
+		return pixels[dstX + dstY * width];
+
+	//bilinear, pixel centers of the destination mapped onto the source
+	auto fx = FMath::Clamp((dstX + 0.5f) * width / dstWidth - 0.5f, 0.0f, (float)(width - 1));
+	auto fy = FMath::Clamp((dstY + 0.5f) * height / dstHeight - 0.5f, 0.0f, (float)(height - 1));
+	int32 x0 = (int32)fx, y0 = (int32)fy;
+	int32 x1 = FMath::Min(x0 + 1, width - 1), y1 = FMath::Min(y0 + 1, height - 1);
+	auto tx = fx - x0, ty = fy - y0;
+
+	auto top = FMath::Lerp(FLinearColor(pixels[x0 + y0 * width].ReinterpretAsLinear()),
+		FLinearColor(pixels[x1 + y0 * width].ReinterpretAsLinear()), tx);
+	auto bottom = FMath::Lerp(FLinearColor(pixels[x0 + y1 * width].ReinterpretAsLinear()),
+		FLinearColor(pixels[x1 + y1 * width].ReinterpretAsLinear()), tx);
+	return FMath::Lerp(top, bottom, ty).QuantizeRound();
+}
+
+UTexture2D* PackedMaskTexture::createTexture(const Sources &sources, const FString &materialPath, JsonImporter *importer){
+	check(importer);
+
+	PackSourceImage occlusion, metallic, detailMask;
+	int32 width = 0, height = 0, maxTextureSize = 0;
+	bool unlimitedSize = false;
+	auto loadSource = [&](PackSourceImage &dst, JsonTextureId texId, const TCHAR *usage) -> bool{
+		if (texId < 0)
+			return true;
+		auto texture = Cast<UTexture2D>(importer->getTexture(texId));
+		if (!texture){
+			UE_LOG(JsonLog, Warning, TEXT("Could not find %s texture %d for mask packing"), usage, texId);
+			return false;
+		}
+		if (!dst.load(texture)){
+			UE_LOG(JsonLog, Warning, TEXT("Texture %d(%s) has unsupported source format for mask packing"), texId, *texture->GetName());
+			return false;
+		}
+		width = FMath::Max(width, dst.width);
+		height = FMath::Max(height, dst.height);
+		if (texture->MaxTextureSize > 0)
+			maxTextureSize = FMath::Max(maxTextureSize, texture->MaxTextureSize);
+		else
+			unlimitedSize = true;
+		return true;
+	};
+
+	if (!loadSource(occlusion, sources.occlusionTex, TEXT("occlusion"))
+		|| !loadSource(metallic, sources.metallicTex, TEXT("metallic"))
+		|| !loadSource(detailMask, sources.detailMaskTex, TEXT("detail mask")))
+		return nullptr;
+	if ((width <= 0) || (height <= 0))
+		return nullptr;
+
+	TArray<FColor> packed;
+	packed.SetNumUninitialized(width * height);
+	ParallelFor(height, [&](int32 y){
+		auto dstScan = packed.GetData() + y * width;
+		for(int32 x = 0; x < width; x++){
+			FColor pixel(255, 255, 0, 255);
+			if (occlusion.pixels.Num())
+				pixel.R = occlusion.sample(x, y, width, height).G;
+			if (metallic.pixels.Num()){
+				auto src = metallic.sample(x, y, width, height);
+				pixel.G = src.A;
+				pixel.B = src.R;
+			}
+			if (detailMask.pixels.Num())
+				pixel.A = detailMask.sample(x, y, width, height).A;
+			dstScan[x] = pixel;
+		}
+	});
+
+	auto dirPath = FPaths::GetPath(materialPath);
+	auto result = createAssetObject<UTexture2D>(sources.makeName(), &dirPath, importer,
+		[&](UTexture2D *tex){
+			tex->Source.Init(width, height, 1, 1, TSF_BGRA8, (const uint8*)packed.GetData());
+			tex->SRGB = false;
+			tex->CompressionSettings = TC_Masks;
+			tex->LODGroup = TEXTUREGROUP_WorldSpecular;
+			tex->MaxTextureSize = unlimitedSize ? 0: maxTextureSize;
+			tex->PostEditChange();
+		}, RF_Standalone|RF_Public
+	);
+
+	if (result){
+		UE_LOG(JsonLog, Log, TEXT("Packed mask texture %s created (%dx%d): occlusion %d, metallic %d, detail mask %d"),
+			*result->GetName(), width, height, sources.occlusionTex, sources.metallicTex, sources.detailMaskTex);
+	}
+	return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "JsonTypes.h"
+
+class JsonImporter;
+class JsonMaterial;
+class MaterialFingerprint;
+class UTexture2D;
+
+/*
+Unity keeps metallic/smoothness, occlusion and detail mask in separate images. Code generated materials sample one
+linear mask texture instead (see MaterialBuilder::usesPackedMaskTemplate), packed as:
+
+R - occlusion (unity reads occlusion from green)
+G - smoothness (metallic alpha)
+B - metallic (metallic red)
+A - detail mask (detail mask alpha)
+
+Missing sources get unity defaults: white occlusion, smoothness and detail mask, zero metallic.
+Packed textures are shared between materials that reference the same combination of sources.
+*/
+namespace PackedMaskTexture{
+	struct Sources{
+		JsonTextureId occlusionTex = -1;
+		JsonTextureId metallicTex = -1;
+		JsonTextureId detailMaskTex = -1;
+
+		static Sources fromMaterial(const JsonMaterial &jsonMat, const MaterialFingerprint &fingerprint);
+		//Packing is only worth it when it replaces at least two different textures.
+		int32 getNumDistinctTextures() const;
+		bool worthPacking() const{
+			return getNumDistinctTextures() >= 2;
+		}
+		FString makeName() const;
+
+		bool operator==(const Sources &other) const{
+			return (occlusionTex == other.occlusionTex) && (metallicTex == other.metallicTex) && (detailMaskTex == other.detailMaskTex);
+		}
+	};
+
+	inline uint32 GetTypeHash(const Sources &sources){
+		return HashCombine(HashCombine(::GetTypeHash(sources.occlusionTex), ::GetTypeHash(sources.metallicTex)),
+			::GetTypeHash(sources.detailMaskTex));
+	}
+
+	/*
+	Source textures are read from their source art, resampled to the largest of them and written into a new texture asset
+	placed next to the material. Returns nullptr if any source is missing or uses unsupported source format.
+	*/
+	UTexture2D* createTexture(const Sources &sources, const FString &materialPath, JsonImporter *importer);
+}
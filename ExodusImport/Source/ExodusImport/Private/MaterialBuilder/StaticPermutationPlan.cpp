@@ -0,0 +1,285 @@
+#include "JsonImportPrivatePCH.h"
+#include "StaticPermutationPlan.h"
+
+#include "JsonImporter.h"
+#include "MaterialBuilder.h"
+#include "MaterialFingerprint.h"
+
+//Order matches StaticPermutationPlan::Switch
+static const StaticPermutationPlan::SwitchInfo switchInfos[StaticPermutationPlan::NumSwitches] = {
+	{"albedoTexEnabled", "albedoTexture", StaticPermutationPlan::NeutralTexture::White, true},
+	{"mainTextureTransformEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, true},
+	{"altSmoothnessSourceEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	//neutral detail albedo is 0.5 grey, there's no such texture among the candidates
+	{"detailAlbedoEnabled", "detailAlbedo", StaticPermutationPlan::NeutralTexture::None, false},
+	{"detailTexTransformEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, true},
+	{"detailMaskEnabled", "detialMask", StaticPermutationPlan::NeutralTexture::White, true},
+	{"detailNormalEnabled", "detailNormalMap", StaticPermutationPlan::NeutralTexture::FlatNormal, true},
+	{"detailNormalScaleEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, true},
+	{"detailUseUv0", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"detailUseUv1", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"detailUseUv2", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"detailUseUv3", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	//emissive color is set even when emission is off, so it is not neutral
+	{"emissionEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"emissionTexEnabled", "emissiveTexture", StaticPermutationPlan::NeutralTexture::White, true},
+	//metallic and smoothness come from the texture instead of parameters when this is on
+	{"metallicTexEnabled", "metallicTex", StaticPermutationPlan::NeutralTexture::None, false},
+	{"normalMapTexEnabled", "normalMapTexture", StaticPermutationPlan::NeutralTexture::FlatNormal, true},
+	{"normalMapScaleEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, true},
+	{"occlusionScaleEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, true},
+	{"occlusionTexEnabled", "occlusionTex", StaticPermutationPlan::NeutralTexture::White, true},
+	{"specularTexEnabled", "specularTex", StaticPermutationPlan::NeutralTexture::None, false},
+	{"specularWorkflowEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"transparencyEnabled", nullptr, StaticPermutationPlan::NeutralTexture::None, false},
+	{"useOpacityMask", nullptr, StaticPermutationPlan::NeutralTexture::None, false}
+};
+
+const StaticPermutationPlan::SwitchInfo& StaticPermutationPlan::getSwitchInfo(int32 index){
+	check((index >= 0) && (index < NumSwitches));
+	return switchInfos[index];
+}
+
+static int32 countSwitches(uint32 switches){
+	int32 result = 0;
+	for(; switches; switches &= switches - 1)
+		result++;
+	return result;
+}
+
+uint32 StaticPermutationPlan::getFoldableMask(){
+	uint32 result = 0;
+	for(int32 i = 0; i < NumSwitches; i++){
+		if (switchInfos[i].foldable)
+			result |= 1u << i;
+	}
+	return result;
+}
+
+JsonTextureId StaticPermutationPlan::getSwitchTexture(const JsonMaterial &jsonMat, int32 index){
+	switch(index){
+		case AlbedoTex:
+			return jsonMat.mainTexture;
+		case DetailAlbedo:
+			return jsonMat.detailAlbedoTex;
+		case DetailMask:
+			return jsonMat.detailMaskTex;
+		case DetailNormal:
+			return jsonMat.detailNormalMapTex;
+		case EmissionTex:
+			return jsonMat.emissionTex;
+		case MetallicTex:
+			return jsonMat.metallicTex;
+		case NormalMapTex:
+			return jsonMat.normalMapTex;
+		case OcclusionTex:
+			return jsonMat.occlusionTex;
+		case SpecularTex:
+			return jsonMat.specularTex;
+		default:
+			return -1;
+	}
+}
+
+uint32 StaticPermutationPlan::makeSwitches(const JsonMaterial &jsonMat, const JsonImporter *importer){
+	check(importer);
+	MaterialFingerprint fingerprint(jsonMat);
+
+	bool values[NumSwitches] = {};
+	for(int32 i = 0; i < NumSwitches; i++){
+		if (switchInfos[i].texParamName)
+			values[i] = importer->getTexture(getSwitchTexture(jsonMat, i)) != nullptr;
+	}
+	values[MainTexTransform] = fingerprint.mainTextureTransform;
+	values[AltSmoothnessSource] = fingerprint.altSmoothnessTexture;
+	values[DetailTexTransform] = fingerprint.detailTextureTransform;
+	values[DetailNormalScale] = fingerprint.detailNormalMapScale;
+	values[DetailUseUv0] = fingerprint.secondaryUv == 0;
+	values[DetailUseUv1] = fingerprint.secondaryUv == 1;
+	values[DetailUseUv2] = fingerprint.secondaryUv == 2;
+	values[DetailUseUv3] = fingerprint.secondaryUv == 3;
+	values[Emission] = fingerprint.emissionEnabled;
+	values[NormalMapScale] = fingerprint.normalMapIntensity;
+	values[OcclusionScale] = fingerprint.occlusionIntensity;
+	values[SpecularWorkflow] = fingerprint.specularModel;
+	values[Transparency] = jsonMat.heuristicNeedsTransparentFlag();
+	values[UseOpacityMask] = jsonMat.isAlphaTestQueue();
+
+	uint32 result = 0;
+	for(int32 i = 0; i < NumSwitches; i++){
+		if (values[i])
+			result |= 1u << i;
+	}
+	return result;
+}
+
+/*
+Rarest sets first. A set can be folded into another set that has the same non-foldable switches
+and every switch of the source turned on. The most common such set is picked.
+*/
+bool StaticPermutationPlan::foldRareSets(TMap<SwitchSet, int32> &counts, TMap<SwitchSet, SwitchSet> &remap) const{
+	auto foldable = getFoldableMask();
+	auto fixed = ~foldable;
+
+	auto moveSet = [&](const SwitchSet &src, const SwitchSet &dst){
+		auto srcCount = counts.FindAndRemoveChecked(src);
+		counts.FindOrAdd(dst) += srcCount;
+		remap.Add(src, dst);
+	};
+
+	while(counts.Num() > settings.maxPermutations){
+		TArray<SwitchSet> order;
+		counts.GenerateKeyArray(order);
+		order.Sort([&](const SwitchSet &a, const SwitchSet &b){
+			return counts[a] < counts[b];
+		});
+
+		const SwitchSet *bestSrc = nullptr;
+		const SwitchSet *bestDst = nullptr;
+		for(const auto &src: order){
+			for(const auto &cur: counts){
+				const auto &dst = cur.Key;
+				if (dst == src)
+					continue;
+				if (((dst.switches & fixed) != (src.switches & fixed)) || ((src.switches & ~dst.switches) != 0))
+					continue;
+				if (!bestDst || (cur.Value > counts[*bestDst]))
+					bestDst = &dst;
+			}
+			if (bestDst){
+				bestSrc = &src;
+				break;
+			}
+		}
+		if (!bestSrc)
+			break;
+		//moveSet modifies the map, so copy the keys out first
+		auto src = *bestSrc, dst = *bestDst;
+		moveSet(src, dst);
+	}
+
+	if (counts.Num() <= settings.maxPermutations)
+		return false;
+
+	TArray<SwitchSet> remaining;
+	counts.GenerateKeyArray(remaining);
+	for(const auto &src: remaining){
+		auto dst = src;
+		dst.switches |= foldable;
+		if (!(dst == src))
+			moveSet(src, dst);
+	}
+	return true;
+}
+
+void StaticPermutationPlan::build(const TArray<JsonMaterial> &materials, const MaterialBuilder &materialBuilder,
+		const JsonImporter *importer, const Settings &newSettings){
+	settings = newSettings;
+	resolvedSwitches.Reset();
+	sourceCounts.Reset();
+	resolvedCounts.Reset();
+	baseMaterialStats.Reset();
+	numFoldedMaterials = 0;
+
+	TMap<JsonId, SwitchSet> sourceSets;
+	for(const auto &jsonMat: materials){
+		//Packed mask materials are instances of generated templates, not of the base materials.
+		if (materialBuilder.usesPackedMaskTemplate(jsonMat, importer))
+			continue;
+		SwitchSet set;
+		set.baseMaterial = materialBuilder.getBaseMaterialPath(jsonMat);
+		set.switches = makeSwitches(jsonMat, importer);
+		sourceSets.Add(jsonMat.id, set);
+		sourceCounts.FindOrAdd(set)++;
+	}
+
+	TMap<FString, TMap<SwitchSet, int32>> baseCounts;
+	for(const auto &cur: sourceCounts){
+		baseCounts.FindOrAdd(cur.Key.baseMaterial).Add(cur.Key, cur.Value);
+		auto &stats = baseMaterialStats.FindOrAdd(cur.Key.baseMaterial);
+		stats.numMaterials += cur.Value;
+		stats.numSourceSets++;
+	}
+
+	TMap<SwitchSet, SwitchSet> remap;
+	for(auto &cur: baseCounts){
+		if (settings.enabled && (settings.maxPermutations > 0))
+			baseMaterialStats[cur.Key].allFoldableOn = foldRareSets(cur.Value, remap);
+		baseMaterialStats[cur.Key].numResolvedSets = cur.Value.Num();
+		resolvedCounts.Append(cur.Value);
+	}
+
+	uint32 textureSwitches = 0;
+	for(int32 i = 0; i < NumSwitches; i++){
+		if (switchInfos[i].texParamName)
+			textureSwitches |= 1u << i;
+	}
+
+	for(const auto &cur: sourceSets){
+		auto set = cur.Value;
+		while(auto next = remap.Find(set))
+			set = *next;
+		resolvedSwitches.Add(cur.Key, set.switches);
+		if (set.switches == cur.Value.switches)
+			continue;
+
+		numFoldedMaterials++;
+		auto added = set.switches & ~cur.Value.switches;
+		auto extraSamples = countSwitches(added & textureSwitches);
+		auto &stats = baseMaterialStats[set.baseMaterial];
+		stats.numFoldedMaterials++;
+		stats.extraSamples += extraSamples;
+		stats.maxExtraSamples = FMath::Max(stats.maxExtraSamples, extraSamples);
+		stats.extraAluSwitches += countSwitches(added & ~textureSwitches);
+	}
+}
+
+uint32 StaticPermutationPlan::resolve(JsonId matId, uint32 sourceSwitches) const{
+	auto found = resolvedSwitches.Find(matId);
+	return found ? *found: sourceSwitches;
+}
+
+FString StaticPermutationPlan::makeReport() const{
+	int32 numMaterials = 0;
+	for(const auto &cur: sourceCounts)
+		numMaterials += cur.Value;
+
+	FString result = FString::Printf(
+		TEXT("Material instances: %d; static permutations: %d in source, %d after folding (budget per base material: %d); materials folded: %d\n")
+		TEXT("Extra texture samples are neutral textures sampled per pixel by folded materials, extra alu switches are transforms and scales.\n\n")
+		TEXT("base material\tinstances\tsource permutations\tpermutations\tfolded materials\textra texture samples\tmax extra samples per material\textra alu switches\tall foldable on\n"),
+		numMaterials, sourceCounts.Num(), resolvedCounts.Num(), settings.maxPermutations, numFoldedMaterials
+	);
+
+	TArray<FString> baseMaterials;
+	baseMaterialStats.GenerateKeyArray(baseMaterials);
+	baseMaterials.Sort();
+	for(const auto &baseMaterial: baseMaterials){
+		const auto &stats = baseMaterialStats[baseMaterial];
+		result += FString::Printf(TEXT("%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s\n"), *baseMaterial,
+			stats.numMaterials, stats.numSourceSets, stats.numResolvedSets, stats.numFoldedMaterials,
+			stats.extraSamples, stats.maxExtraSamples, stats.extraAluSwitches, stats.allFoldableOn ? TEXT("yes"): TEXT("no"));
+	}
+	result += TEXT("\nbase material\tinstances\tswitches\n");
+
+	TArray<SwitchSet> order;
+	resolvedCounts.GenerateKeyArray(order);
+	order.Sort([&](const SwitchSet &a, const SwitchSet &b){
+		if (a.baseMaterial != b.baseMaterial)
+			return a.baseMaterial < b.baseMaterial;
+		return resolvedCounts[a] > resolvedCounts[b];
+	});
+
+	for(const auto &set: order){
+		FString switchNames;
+		for(int32 i = 0; i < NumSwitches; i++){
+			if (!(set.switches & (1u << i)))
+				continue;
+			if (switchNames.Len())
+				switchNames += TEXT(" ");
+			switchNames += switchInfos[i].switchName;
+		}
+		result += FString::Printf(TEXT("%s\t%d\t%s\n"), *set.baseMaterial, resolvedCounts[set], *switchNames);
+	}
+	return result;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "JsonTypes.h"
+
+class JsonImporter;
+class JsonMaterial;
+class MaterialBuilder;
+
+/*
+Static switch sets of imported material instances. Every distinct set is one more shader permutation of its base material
+that has to be compiled and stored.
+
+Some switches can be turned on without changing the result, because the parameter behind them then holds a neutral value:
+a white texture for albedo, detail mask, emission and occlusion, a flat normal map, identity texture transforms,
+and normal/occlusion intensity of 1. The budget is per base material: when a base material has more distinct sets than 
+maxPermutations, its rarest sets are folded into the most common set that differs from them only by such switches being on. 
+If that is not enough, every foldable switch is turned on in all remaining sets of that base material.
+A folded material samples a neutral texture for every texture switch it did not need, the report lists that cost.
+*/
+class StaticPermutationPlan{
+public:
+	enum Switch: uint8{
+		AlbedoTex = 0,
+		MainTexTransform,
+		AltSmoothnessSource,
+		DetailAlbedo,
+		DetailTexTransform,
+		DetailMask,
+		DetailNormal,
+		DetailNormalScale,
+		DetailUseUv0,
+		DetailUseUv1,
+		DetailUseUv2,
+		DetailUseUv3,
+		Emission,
+		EmissionTex,
+		MetallicTex,
+		NormalMapTex,
+		NormalMapScale,
+		OcclusionScale,
+		OcclusionTex,
+		SpecularTex,
+		SpecularWorkflow,
+		Transparency,
+		UseOpacityMask,
+		NumSwitches
+	};
+
+	enum class NeutralTexture: uint8{
+		None,
+		White,
+		FlatNormal
+	};
+
+	struct SwitchInfo{
+		const char *switchName;
+		//Texture controlled by the switch, if any
+		const char *texParamName;
+		//Value that makes the switch safe to turn on when the texture is missing
+		NeutralTexture neutral;
+		bool foldable;
+	};
+
+	struct Settings{
+		bool enabled = true;
+		//Per base material. 0 means no limit
+		int32 maxPermutations = 16;
+	};
+
+	struct SwitchSet{
+		FString baseMaterial;
+		uint32 switches = 0;
+
+		bool operator==(const SwitchSet &other) const{
+			return (switches == other.switches) && (baseMaterial == other.baseMaterial);
+		}
+	};
+
+	struct BaseMaterialStats{
+		int32 numMaterials = 0;
+		int32 numSourceSets = 0;
+		int32 numResolvedSets = 0;
+		int32 numFoldedMaterials = 0;
+		//Neutral texture samples added by folding, summed over materials and the largest for a single material.
+		int32 extraSamples = 0;
+		int32 maxExtraSamples = 0;
+		//Switches without a texture (transforms and scales) turned on by folding, summed over materials.
+		int32 extraAluSwitches = 0;
+		//Every foldable switch was turned on, because folding alone did not fit the budget.
+		bool allFoldableOn = false;
+	};
+protected:
+	Settings settings;
+	//Switches of every material id after folding.
+	TMap<JsonId, uint32> resolvedSwitches;
+	//Number of materials using each set, before and after folding.
+	TMap<SwitchSet, int32> sourceCounts;
+	TMap<SwitchSet, int32> resolvedCounts;
+	TMap<FString, BaseMaterialStats> baseMaterialStats;
+	int32 numFoldedMaterials = 0;
+
+	static uint32 getFoldableMask();
+	//counts holds the sets of a single base material. Returns true if every foldable switch had to be turned on.
+	bool foldRareSets(TMap<SwitchSet, int32> &counts, TMap<SwitchSet, SwitchSet> &remap) const;
+public:
+	static const SwitchInfo& getSwitchInfo(int32 index);
+	static JsonTextureId getSwitchTexture(const JsonMaterial &jsonMat, int32 index);
+	//Switch values the material needs, one bit per Switch.
+	static uint32 makeSwitches(const JsonMaterial &jsonMat, const JsonImporter *importer);
+
+	void build(const TArray<JsonMaterial> &materials, const MaterialBuilder &materialBuilder, const JsonImporter *importer, const Settings &newSettings);
+	//Switches to use for the material. Materials the plan does not know about keep their own switches.
+	uint32 resolve(JsonId matId, uint32 sourceSwitches) const;
+
+	int32 getNumSourcePermutations() const{
+		return sourceCounts.Num();
+	}
+	int32 getNumResolvedPermutations() const{
+		return resolvedCounts.Num();
+	}
+	int32 getNumFoldedMaterials() const{
+		return numFoldedMaterials;
+	}
+	FString makeReport() const;
+};
+
+inline uint32 GetTypeHash(const StaticPermutationPlan::SwitchSet &set){
+	return HashCombine(GetTypeHash(set.baseMaterial), GetTypeHash(set.switches));
+}
@@ -5,16 +5,44 @@
 #include <functional>
 
 class UStaticMesh;
+struct FStaticMeshSourceModel;
 class USkeletalMesh;
 class UMaterial;
 class UMaterialInterface;
 class JsonImporter;
 
+namespace MeshBuilderUtils{
+	struct LightmapUvInfo;
+}
+
 class MeshBuilder{
 public:
-	void setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, std::function<void(TArray<FStaticMaterial> &meshMaterials)> materialSetup);
+	/*
+	How mesh colliders use the mesh. The exporter sets convex/triangle flags on meshes referenced by mesh colliders, 
+	meshes without either flag are render-only.
+	*/
+	enum class CollisionUsage{
+		None, Convex, Triangles
+	};
+	static CollisionUsage getCollisionUsage(const JsonMesh &jsonMesh);
+
+	//renderOnly forces CollisionUsage::None, used for terrain details and other generated meshes.
+	//convexHullPoints, if provided, are used for convex collision instead of reducing the mesh vertices on the spot.
+	//lightmapUvInfo, if provided, is used instead of analyzing uv1 on the spot.
+	void setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, std::function<void(TArray<FStaticMaterial> &meshMaterials)> materialSetup, 
+		bool renderOnly = false, const TArray<FVector> *convexHullPoints = nullptr, const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo = nullptr);
 	void generateBillboardMesh(UStaticMesh *staticMesh, UMaterialInterface *billboardMaterial);
+
+	struct ConvexCollisionCook{
+		UStaticMesh *mesh = nullptr;
+		const JsonMesh *jsonMesh = nullptr;
+	};
+	//Convex collision set up by setupStaticMesh is cooked by this, once per batch of imported meshes.
+	void cookConvexCollision(const TArray<ConvexCollisionCook> &cooks);
 	MeshBuilder() = default;
 protected:
+	void setupFallbackCollision(UStaticMesh *mesh, const JsonMesh &jsonMesh);
+	void setupStaticMeshCollision(UStaticMesh *mesh, const JsonMesh &jsonMesh, CollisionUsage usage, const TArray<FVector> *convexHullPoints);
+	void setupStaticMeshLightmap(UStaticMesh *mesh, FStaticMeshSourceModel &srcModel, const JsonMesh &jsonMesh, const MeshBuilderUtils::LightmapUvInfo &lightmapUvInfo);
 };
 
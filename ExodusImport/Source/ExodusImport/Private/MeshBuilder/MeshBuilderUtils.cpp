@@ -1,6 +1,7 @@
 #include "JsonImportPrivatePCH.h"
 #include "MeshBuilderUtils.h"
 #include "UnrealUtilities.h"
+#include "JsonObjects/JsonMesh.h"
 
 using namespace UnrealUtilities;
 
@@ -35,3 +36,125 @@ void MeshBuilderUtils::processTangent(int originalIndex, const FloatArray &normF
 	//newRawMesh.WedgeTangentY.Add(vTanUnreal);
 }
 
+
+TArray<FVector> MeshBuilderUtils::buildConvexHullPoints(const FloatArray &unityVertFloats, int32 maxVerts){
+	TArray<FVector> points;
+	points.Reserve(unityVertFloats.Num() / 3);
+	for(int32 i = 0; (i + 2) < unityVertFloats.Num(); i += 3){
+		points.Add(unityPosToUe(FVector(unityVertFloats[i], unityVertFloats[i + 1], unityVertFloats[i + 2])));
+	}
+
+	if ((maxVerts <= 0) || (points.Num() <= maxVerts))
+		return points;
+
+	//Fibonacci sphere. Two directions per output point, since neighbouring directions often share an extreme vertex.
+	const int32 numDirs = maxVerts * 2;
+	const float goldenAngle = PI * (3.0f - FMath::Sqrt(5.0f));
+	TBitArray<> used(false, points.Num());
+	TArray<FVector> result;
+	result.Reserve(maxVerts);
+	for(int32 dirIndex = 0; (dirIndex < numDirs) && (result.Num() < maxVerts); dirIndex++){
+		float z = 1.0f - 2.0f * ((float)dirIndex + 0.5f) / (float)numDirs;
+		float r = FMath::Sqrt(FMath::Max(0.0f, 1.0f - z * z));
+		float angle = goldenAngle * (float)dirIndex;
+		FVector dir(r * FMath::Cos(angle), r * FMath::Sin(angle), z);
+
+		int32 bestIndex = 0;
+		float bestDot = FVector::DotProduct(points[0], dir);
+		for(int32 i = 1; i < points.Num(); i++){
+			float curDot = FVector::DotProduct(points[i], dir);
+			if (curDot > bestDot){
+				bestDot = curDot;
+				bestIndex = i;
+			}
+		}
+		if (used[bestIndex])
+			continue;
+		used[bestIndex] = true;
+		result.Add(points[bestIndex]);
+	}
+	return result;
+}
+
+int32 MeshBuilderUtils::LightmapUvSettings::getResolution(float surfaceArea, float scale) const{
+	//unreal units are centimeters
+	auto areaMeters = FMath::Max(surfaceArea, 0.0f) / 10000.0f;
+	auto texels = FMath::Sqrt(areaMeters) * texelsPerMeter * FMath::Abs(scale);
+	auto result = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(FMath::CeilToInt(texels), 1));
+	return FMath::Clamp(result, minResolution, maxResolution);
+}
+
+MeshBuilderUtils::LightmapUvInfo MeshBuilderUtils::analyzeLightmapUvs(const JsonMesh &jsonMesh, const LightmapUvSettings &settings){
+	LightmapUvInfo result;
+	const auto &verts = jsonMesh.verts;
+	const auto &uvs = jsonMesh.uv1;
+	const auto numVerts = verts.Num() / 3;
+	result.hasUvs = (uvs.Num() / 2) >= numVerts && numVerts > 0;
+
+	for(const auto &subMesh: jsonMesh.subMeshes){
+		const auto &trigs = subMesh.triangles;
+		for(int32 i = 0; (i + 2) < trigs.Num(); i += 3){
+			auto a = unityPosToUe(getIdxVector3(verts, trigs[i]));
+			auto b = unityPosToUe(getIdxVector3(verts, trigs[i + 1]));
+			auto c = unityPosToUe(getIdxVector3(verts, trigs[i + 2]));
+			result.surfaceArea += FVector::CrossProduct(b - a, c - a).Size() * 0.5f;
+		}
+	}
+	result.resolution = settings.getResolution(result.surfaceArea);
+
+	if (!result.hasUvs)
+		return result;
+
+	const float rangeEpsilon = 0.001f;
+	for(int32 i = 0; i < numVerts * 2; i++){
+		if ((uvs[i] < -rangeEpsilon) || (uvs[i] > 1.0f + rangeEpsilon)){
+			result.outOfRange = true;
+			return result;
+		}
+	}
+
+	/*
+	Triangles are rasterized by texel centers, strictly inside test. 
+	Shared edges between neighbouring triangles do not count as overlap this way.
+	*/
+	const int32 gridSize = FMath::Clamp(result.resolution, 1, FMath::Max(settings.maxOverlapGridSize, 1));
+	TArray<uint8> coverage;
+	coverage.SetNumZeroed(gridSize * gridSize);
+	int32 numCovered = 0, numOverlapped = 0;
+	for(const auto &subMesh: jsonMesh.subMeshes){
+		const auto &trigs = subMesh.triangles;
+		for(int32 i = 0; (i + 2) < trigs.Num(); i += 3){
+			auto a = getIdxVector2(uvs, trigs[i]) * (float)gridSize;
+			auto b = getIdxVector2(uvs, trigs[i + 1]) * (float)gridSize;
+			auto c = getIdxVector2(uvs, trigs[i + 2]) * (float)gridSize;
+			auto area = FVector2D::CrossProduct(b - a, c - a);
+			if (FMath::IsNearlyZero(area))
+				continue;
+
+			auto minX = FMath::Clamp(FMath::FloorToInt(FMath::Min3(a.X, b.X, c.X)), 0, gridSize - 1);
+			auto maxX = FMath::Clamp(FMath::CeilToInt(FMath::Max3(a.X, b.X, c.X)), 0, gridSize - 1);
+			auto minY = FMath::Clamp(FMath::FloorToInt(FMath::Min3(a.Y, b.Y, c.Y)), 0, gridSize - 1);
+			auto maxY = FMath::Clamp(FMath::CeilToInt(FMath::Max3(a.Y, b.Y, c.Y)), 0, gridSize - 1);
+			for(int32 y = minY; y <= maxY; y++){
+				for(int32 x = minX; x <= maxX; x++){
+					FVector2D p((float)x + 0.5f, (float)y + 0.5f);
+					auto w0 = FVector2D::CrossProduct(b - a, p - a) / area;
+					auto w1 = FVector2D::CrossProduct(c - b, p - b) / area;
+					auto w2 = FVector2D::CrossProduct(a - c, p - c) / area;
+					if ((w0 <= 0.0f) || (w1 <= 0.0f) || (w2 <= 0.0f))
+						continue;
+					auto &texel = coverage[y * gridSize + x];
+					if (texel == 0)
+						numCovered++;
+					else if (texel == 1)
+						numOverlapped++;
+					if (texel < 2)
+						texel++;
+				}
+			}
+		}
+	}
+
+	result.overlapping = (numCovered > 0) && ((float)numOverlapped > (float)numCovered * settings.overlapTolerance);
+	return result;
+}
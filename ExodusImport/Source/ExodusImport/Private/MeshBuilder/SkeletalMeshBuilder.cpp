@@ -212,82 +212,126 @@ void SkeletalMeshBuildData::computeBoundingBox(USkeletalMesh *skelMesh, const Js
 	skelMesh->SetImportedBounds(FBoxSphereBounds(boundBox));
 }
 
-struct SkeletalMeshInfluence{
-	int boneIndex = 0;
-	float weight = 0.0f;
-	int intWeight = 0;
-	void recomputeInt(){
-		intWeight = (int)(255.0f * weight);
-	}
-	void recomputeFloat(){
-		weight = ((float)intWeight)/255.0f;
+/*
+Bone influences are kept in flat fixed-stride arrays instead of a per-vertex map of arrays.
+Unity never exports more than 4 influences per vertex, so a single vertex fits into one vector register,
+and the whole mesh is processed without hashing or per-vertex allocations.
+*/
+struct SkeletalMeshInfluenceBuffer{
+	static const int stride = 4;
+
+	IntArray boneIndexes;
+	FloatArray weights;
+	IntArray intWeights;
+	ByteArray counts;
+	int numVertices = 0;
+
+	void reset(int numVertices_){
+		numVertices = numVertices_;
+		boneIndexes.SetNumZeroed(numVertices * stride);
+		weights.SetNumZeroed(numVertices * stride);
+		intWeights.SetNumZeroed(numVertices * stride);
+		counts.SetNumZeroed(numVertices);
 	}
-	SkeletalMeshInfluence() = default;
-	SkeletalMeshInfluence(int boneIndex_, float weight_)
-	:boneIndex(boneIndex_), weight(weight_){
-		intWeight = (int)(weight * 255.0f);//truncate
+
+	int getNumInfluences() const{
+		int result = 0;
+		for(auto cur: counts)
+			result += cur;
+		return result;
 	}
-};
 
-using SkeletalMeshInfluenceArray = TArray<SkeletalMeshInfluence>;
-using BoneInfluenceMap = TMap<int, SkeletalMeshInfluenceArray>;
+	void add(int vertIndex, int boneIndex, float weight){
+		auto &count = counts[vertIndex];
+		check(count < stride);
+		auto offset = vertIndex * stride + count;
+		boneIndexes[offset] = boneIndex;
+		weights[offset] = weight;
+		intWeights[offset] = (int)(weight * 255.0f);//truncate
+		count++;
+	}
 
-float getTotalWeight(const SkeletalMeshInfluenceArray &arr){
-	float result = 0.0f;
-	for(const auto &cur: arr){
-		result += cur.weight;
+	float getTotalWeight(int vertIndex) const{
+		float result = 0.0f;
+		for(int i = 0; i < counts[vertIndex]; i++)
+			result += weights[vertIndex * stride + i];
+		return result;
 	}
-	return result;
-}
 
-int getTotalIntWeight(const SkeletalMeshInfluenceArray &arr){
-	int result = 0;
-	for(const auto &cur: arr){
-		result += cur.intWeight;
+	int getTotalIntWeight(int vertIndex) const{
+		int result = 0;
+		for(int i = 0; i < counts[vertIndex]; i++)
+			result += intWeights[vertIndex * stride + i];
+		return result;
 	}
-	return result;
-}
 
-void printBoneInfluenceMap(const BoneInfluenceMap &boneInfluences){
-	for(auto &cur: boneInfluences){
-		UE_LOG(JsonLog, Log, TEXT("Influence for vert %d: %f (%d)"), cur.Key, getTotalWeight(cur.Value), getTotalIntWeight(cur.Value));
-		for(int i = 0; i < cur.Value.Num(); i++){
-			UE_LOG(JsonLog, Log, TEXT("Influence %d/%d: %f (%d)"), i, cur.Value.Num(), cur.Value[i].weight, cur.Value[i].intWeight);
+	void sortVertex(int vertIndex);
+	void normalizeVertex(int vertIndex);
+	void print() const;
+};
+
+//Sorting the influences from strongest to weakest. Insertion sort, as there's at most 4 of them.
+void SkeletalMeshInfluenceBuffer::sortVertex(int vertIndex){
+	const auto offset = vertIndex * stride;
+	const auto count = counts[vertIndex];
+	for(int i = 1; i < count; i++){
+		auto curBone = boneIndexes[offset + i];
+		auto curWeight = weights[offset + i];
+		int j = i - 1;
+		for(; (j >= 0) && (weights[offset + j] < curWeight); j--){
+			boneIndexes[offset + j + 1] = boneIndexes[offset + j];
+			weights[offset + j + 1] = weights[offset + j];
 		}
+		boneIndexes[offset + j + 1] = curBone;
+		weights[offset + j + 1] = curWeight;
 	}
 }
 
-void normalizeInfluenceMap(BoneInfluenceMap &boneInfluences){
-	for(auto &cur: boneInfluences){
-		if (cur.Value.Num() == 0)
-			continue;
+/*
+the mapping to uint8 for bone weights is troublesome.
 
-		for(auto &infl: cur.Value){
-			infl.weight = FMath::Clamp(infl.weight, 0.0f, 1.0f);
-			infl.recomputeInt();
-		}
+Weights are clamped, scaled down if they sum above 1, truncated to 0..255 integers, 
+and whatever is left of 255 goes to the strongest influence. Unused slots hold zero weight and do not affect the sums.
+*/
+void SkeletalMeshInfluenceBuffer::normalizeVertex(int vertIndex){
+	if (counts[vertIndex] == 0)
+		return;
 
-		float totalFloat = getTotalWeight(cur.Value);
-		if ((totalFloat > 1.0f) && (totalFloat != 0.0f)){
-			float scale = 1.0f/totalFloat;
-			for(auto &infl: cur.Value){
-				infl.weight *= scale;
-				infl.recomputeInt();
-			}
-		}
+	const auto offset = vertIndex * stride;
+	float *vertWeights = &weights[offset];
+	int32 *vertIntWeights = &intWeights[offset];
 
-		int totalInt = getTotalIntWeight(cur.Value);
-		check((totalInt >= 0) && (totalInt <= 255));//This shouldn't fire at this point, but you never know.
+	auto weightVec = VectorLoad(vertWeights);
+	weightVec = VectorMin(VectorMax(weightVec, VectorZero()), VectorOne());
 
-		auto extra = 255 - totalInt;
-		if (extra > 0){
-			auto& largest = cur.Value[0];
-			largest.intWeight += extra;
-			largest.recomputeFloat();
-		}
+	auto totalVec = VectorDot4(weightVec, VectorOne());
+	if (VectorGetComponent(totalVec, 0) > 1.0f){
+		weightVec = VectorDivide(weightVec, totalVec);
+	}
+
+	VectorIntStore(VectorFloatToInt(VectorMultiply(weightVec, VectorSetFloat1(255.0f))), vertIntWeights);
 
-		for(auto &infl: cur.Value){
-			infl.recomputeFloat();
+	int totalInt = vertIntWeights[0] + vertIntWeights[1] + vertIntWeights[2] + vertIntWeights[3];
+	check((totalInt >= 0) && (totalInt <= 255));//This shouldn't fire at this point, but you never know.
+
+	auto extra = 255 - totalInt;
+	if (extra > 0){
+		vertIntWeights[0] += extra;
+	}
+
+	weightVec = VectorMultiply(VectorIntToFloat(VectorIntLoad(vertIntWeights)), VectorSetFloat1(1.0f/255.0f));
+	VectorStore(weightVec, vertWeights);
+}
+
+void SkeletalMeshInfluenceBuffer::print() const{
+	for(int vertIndex = 0; vertIndex < numVertices; vertIndex++){
+		const auto count = counts[vertIndex];
+		if (!count)
+			continue;
+		UE_LOG(JsonLog, Log, TEXT("Influence for vert %d: %f (%d)"), vertIndex, getTotalWeight(vertIndex), getTotalIntWeight(vertIndex));
+		for(int i = 0; i < count; i++){
+			auto offset = vertIndex * stride + i;
+			UE_LOG(JsonLog, Log, TEXT("Influence %d/%d: %f (%d)"), i, (int)count, weights[offset], intWeights[offset]);
 		}
 	}
 }
@@ -296,21 +340,39 @@ void normalizeInfluenceMap(BoneInfluenceMap &boneInfluences){
 
 void SkeletalMeshBuildData::processPositionsAndWeights(const JsonMesh &jsonMesh, const TMap<int, int> &meshToSkeletonBoneMap, StringArray &remapErrors){
 	const int jsonInfluencesPerVertex = 4;
+	static_assert(jsonInfluencesPerVertex <= SkeletalMeshInfluenceBuffer::stride, "Influence buffer stride is too small");
 
 	bool hasBones = jsonMesh.boneIndexes.Num() > 0;
 
 	//vertices themselves
+	meshPoints.Reserve(meshPoints.Num() + jsonMesh.vertexCount);
+	pointToOriginalMap.Reserve(pointToOriginalMap.Num() + jsonMesh.vertexCount);
 	for(int vertIndex = 0; vertIndex < jsonMesh.vertexCount; vertIndex++){
 		auto srcVert = getIdxVector3(jsonMesh.verts, vertIndex);
 		meshPoints.Add(unityPosToUe(srcVert));
 		pointToOriginalMap.Add(vertIndex);
 	}
 
-	/*
-	the mapping to uint8 for bone weights is troublesome.
-	*/
-	TMap<int, SkeletalMeshInfluenceArray> boneInfluences;
+	SkeletalMeshInfluenceBuffer boneInfluences;
+	boneInfluences.reset(jsonMesh.vertexCount);
+
 	if (hasBones){
+		//Flat remap table, so the per-influence lookup is an index rather than a hash probe.
+		const int unmappedBone = TNumericLimits<int32>::Lowest();
+		IntArray boneRemap;
+		for(const auto &cur: meshToSkeletonBoneMap){
+			if (cur.Key < 0)
+				continue;
+			if (cur.Key >= boneRemap.Num())
+				boneRemap.SetNum(cur.Key + 1);
+		}
+		for(auto &cur: boneRemap)
+			cur = unmappedBone;
+		for(const auto &cur: meshToSkeletonBoneMap){
+			if (cur.Key >= 0)
+				boneRemap[cur.Key] = cur.Value;
+		}
+
 		for(int vertIndex = 0; vertIndex < jsonMesh.vertexCount; vertIndex++){
 			for(int inflIndex = 0; inflIndex < jsonInfluencesPerVertex; inflIndex++){
 				auto dataOffset = inflIndex + vertIndex * jsonInfluencesPerVertex;
@@ -321,18 +383,17 @@ void SkeletalMeshBuildData::processPositionsAndWeights(const JsonMesh &jsonMesh,
 					continue;
 
 				auto skelBoneIdx = meshBoneIdx;
-				auto foundIdx = meshToSkeletonBoneMap.Find(meshBoneIdx);
-				if (!foundIdx){
+				auto remapped = boneRemap.IsValidIndex(meshBoneIdx) ? boneRemap[meshBoneIdx]: unmappedBone;
+				if (remapped == unmappedBone){
 					remapErrors.Add(
 						FString::Printf(TEXT("Could not remap mesh bone index %d in vertex influence, errors are possible"),
 							meshBoneIdx));
 				}
 				else{
-					skelBoneIdx = *foundIdx;
+					skelBoneIdx = remapped;
 				}
 
-				SkeletalMeshInfluence tmpInfluence(skelBoneIdx, boneWeight);
-				boneInfluences.FindOrAdd(vertIndex).Add(tmpInfluence);
+				boneInfluences.add(vertIndex, skelBoneIdx, boneWeight);
 			}
 		}
 	}
@@ -352,41 +413,35 @@ void SkeletalMeshBuildData::processPositionsAndWeights(const JsonMesh &jsonMesh,
 			remappedIndex = *foundIdx;
 		}
 		for(int vertIndex = 0; vertIndex < jsonMesh.vertexCount; vertIndex++){
-			SkeletalMeshInfluence tmpInfluence(remappedIndex, 1.0f);
-			boneInfluences.FindOrAdd(vertIndex).Add(tmpInfluence);
+			boneInfluences.add(vertIndex, remappedIndex, 1.0f);
 		}
 	}
 
 #ifdef EXODUS_SKELETAL_MESH_SKIN_LOGGING
-	UE_LOG(JsonLog, Log, TEXT("Pre-sort bone influences on %s(%d)"), *jsonMesh.name, jsonMesh.id);
-	printBoneInfluenceMap(boneInfluences);
+	UE_LOG(JsonLog, Log, TEXT("Pre-sort bone influences on %s(%d)"), *jsonMesh.name, (int)jsonMesh.id);
+	boneInfluences.print();
 #endif
 
-	//Sorting the influences from strongest to weakest
-	for(auto &cur: boneInfluences){
-		Algo::SortBy(cur.Value, [](const SkeletalMeshInfluence &arg){return -arg.weight;});
+	for(int vertIndex = 0; vertIndex < boneInfluences.numVertices; vertIndex++){
+		boneInfluences.sortVertex(vertIndex);
+		boneInfluences.normalizeVertex(vertIndex);
 	}
 
 #ifdef EXODUS_SKELETAL_MESH_SKIN_LOGGING
-	UE_LOG(JsonLog, Log, TEXT("Post-sort bone influences on %s(%d)"), *jsonMesh.name, jsonMesh.id);
-	printBoneInfluenceMap(boneInfluences);
+	UE_LOG(JsonLog, Log, TEXT("Post-normalization bone influences on %s(%d)"), *jsonMesh.name, (int)jsonMesh.id);
+	boneInfluences.print();
 #endif
 
-	normalizeInfluenceMap(boneInfluences);
-
-#ifdef EXODUS_SKELETAL_MESH_SKIN_LOGGING
-	UE_LOG(JsonLog, Log, TEXT("Post-normalization bone influences on %s(%d)"), *jsonMesh.name, jsonMesh.id);
-	printBoneInfluenceMap(boneInfluences);
-#endif
-
-	for(const auto &cur: boneInfluences){
+	meshInfluences.Reserve(meshInfluences.Num() + boneInfluences.getNumInfluences());
+	for(int vertIndex = 0; vertIndex < boneInfluences.numVertices; vertIndex++){
 		float total = 0.0f;
-		for(const auto &infl: cur.Value){
+		const auto offset = vertIndex * SkeletalMeshInfluenceBuffer::stride;
+		for(int i = 0; i < boneInfluences.counts[vertIndex]; i++){
 			auto &dstInfl = meshInfluences.AddDefaulted_GetRef();
-			dstInfl.VertIndex = cur.Key;
-			dstInfl.BoneIndex = infl.boneIndex;//meshBoneIdx;
-			dstInfl.Weight = infl.weight;// * 2.0f;
-			total += infl.weight;
+			dstInfl.VertIndex = vertIndex;
+			dstInfl.BoneIndex = boneInfluences.boneIndexes[offset + i];
+			dstInfl.Weight = boneInfluences.weights[offset + i];
+			total += dstInfl.Weight;
 
 			if (total >= 256.0f/255.0f){
 				UE_LOG(JsonLog, Log, TEXT("Total overflow: %f on vertex %d"), total, dstInfl.VertIndex);
@@ -395,57 +450,29 @@ void SkeletalMeshBuildData::processPositionsAndWeights(const JsonMesh &jsonMesh,
 	}
 
 #ifdef EXODUS_SKELETAL_MESH_SKIN_LOGGING
-	for(auto& cur: boneInfluences){
-		auto &influences = cur.Value;
-		
-		auto totalInt = getTotalIntWeight(influences);
-		auto totalFloat = getTotalWeight(influences);
+	for(int vertIndex = 0; vertIndex < boneInfluences.numVertices; vertIndex++){
+		if (!boneInfluences.counts[vertIndex]){
+			UE_LOG(JsonLog, Warning, TEXT("Unbound skin vertex %d on mesh %s(%d)"), vertIndex, *jsonMesh.name, (int)jsonMesh.id);
+			continue;
+		}
+
+		auto totalInt = boneInfluences.getTotalIntWeight(vertIndex);
+		auto totalFloat = boneInfluences.getTotalWeight(vertIndex);
 		if (totalFloat != 1.0f){
 			UE_LOG(JsonLog, Warning, TEXT("Invalid total bone on vertex %d, mesh %s (%d), value %f"),
-				cur.Key, *jsonMesh.name, jsonMesh.id, totalFloat);
+				vertIndex, *jsonMesh.name, (int)jsonMesh.id, totalFloat);
 		}
 		if (totalInt != 255){
 			UE_LOG(JsonLog, Warning, TEXT("Invalid total int bone on vertex %d, mesh %s (%d), value %d"),
-				cur.Key, *jsonMesh.name, jsonMesh.id, totalInt);
+				vertIndex, *jsonMesh.name, (int)jsonMesh.id, totalInt);
 			if (totalInt > 255){
 				UE_LOG(JsonLog, Warning, TEXT("Value is too large and will result in wraparound!"));
 			}
 		}
 	}
-
-	for(const auto &cur: summaryIntWeightMap){
-		if ((cur.Value > 255) || (cur.Value < 0)){
-			UE_LOG(JsonLog, Warning, TEXT("Invalid total int weight %d on vertex %d, mesh %s (%d)"),
-				cur.Value, cur.Key, *jsonMesh.name, jsonMesh.id)
-		}
-	}
-
-	for(int vertIndex = 0; vertIndex < jsonMesh.vertexCount; vertIndex++){
-		if (!summaryWeightMap.Contains(vertIndex)){
-			UE_LOG(JsonLog, Warning, TEXT("Unbound skin vertex %d on mesh %s(%d)"), vertIndex, *jsonMesh.name, jsonMesh.id);
-		}
-	}
-
-	for(const auto &cur: summaryWeightMap){
-		auto &curIndexes = cur.Value;
-		for(const auto influeneIndexes: curIndexes){
-		}
-	}
-
-	for(const auto &cur: summaryWeightMap){
-		if (cur.Value > 1.0f){
-			UE_LOG(JsonLog, Warning, TEXT("Bone weight value %f is too high on vertex %d, mesh %s (%d)"),
-				cur.Value, cur.Key, *jsonMesh.name, jsonMesh.id)
-		}
-		if (cur.Value < 1.0f){
-			UE_LOG(JsonLog, Warning, TEXT("Bone weight value %f is too low on vertex %d, mesh %s (%d)"),
-				cur.Value, cur.Key, *jsonMesh.name, jsonMesh.id)
-		}
-	}
 #endif
 }
 
-
 void SkeletalMeshBuilder::registerPreviewMesh(USkeleton *skel, USkeletalMesh *mesh, const JsonMesh &jsonMesh){
 	check(skel);
 	check(mesh);
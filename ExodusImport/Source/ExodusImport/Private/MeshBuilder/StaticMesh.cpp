@@ -6,7 +6,141 @@
 #include "Editor/UnrealEd/Private/GeomFitUtils.h"
 #include "PhysicsEngine/BodySetup.h"
 
-void MeshBuilder::setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, std::function<void(TArray<FStaticMaterial> &meshMaterial)> materialSetup){
+MeshBuilder::CollisionUsage MeshBuilder::getCollisionUsage(const JsonMesh &jsonMesh){
+	if (jsonMesh.convexCollider)
+		return CollisionUsage::Convex;
+	if (jsonMesh.triangleCollider)
+		return CollisionUsage::Triangles;
+	return CollisionUsage::None;
+}
+
+static bool hasCookedConvexMesh(const FKConvexElem &elem){
+#if defined(PHYSICS_INTERFACE_PHYSX)
+	#if PHYSICS_INTERFACE_PHYSX
+	return elem.GetConvexMesh() != nullptr;
+	#else
+	//Cooked chaos geometry is not exposed the same way across engine versions, source points are all we can check.
+	return elem.VertexData.Num() > 0;
+	#endif
+#elif WITH_PHYSX
+	return elem.GetConvexMesh() != nullptr;
+#else
+	return elem.VertexData.Num() > 0;
+#endif
+}
+
+/*
+Unity does not generate collision for meshes by default, only mesh colliders do, and a collider is either convex or uses triangles.
+This mirrors it:
+	Render-only meshes get no simple collision at all.
+	Convex meshes get a single convex hull from at most defaultMaxConvexHullVerts hull points. 
+	The hull is not cooked here, see cookConvexCollision.
+	Triangle meshes use complex as simple, and simple collision is not generated.
+*/
+void MeshBuilder::setupStaticMeshCollision(UStaticMesh *mesh, const JsonMesh &jsonMesh, CollisionUsage usage, const TArray<FVector> *convexHullPoints){
+	check(mesh);
+	if (!mesh->BodySetup)
+		mesh->CreateBodySetup();
+	UBodySetup* bodySetup = mesh->BodySetup;
+	if (!bodySetup){
+		if (usage != CollisionUsage::None)
+			UE_LOG(JsonLog, Warning, TEXT("Could not setup collision for mesh %d(\"%s\") - body setup not generated"), (int)jsonMesh.id, *jsonMesh.name);
+		return;
+	}
+
+	bodySetup->RemoveSimpleCollision();
+	if (usage == CollisionUsage::None){
+		bodySetup->CollisionTraceFlag = CTF_UseDefault;
+		return;
+	}
+	if (usage == CollisionUsage::Triangles){
+		bodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		bodySetup->InvalidatePhysicsData();
+		return;
+	}
+
+	bodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+	FKConvexElem hull;
+	if (convexHullPoints)
+		hull.VertexData = *convexHullPoints;
+	else
+		hull.VertexData = MeshBuilderUtils::buildConvexHullPoints(jsonMesh.verts, MeshBuilderUtils::defaultMaxConvexHullVerts);
+
+	//Degenerate hulls (empty or flat meshes) would leave an unusable convex element.
+	if (hull.VertexData.Num() >= 4){
+		hull.UpdateElemBox();
+		bodySetup->AggGeom.ConvexElems.Add(hull);
+		bodySetup->InvalidatePhysicsData();
+	}
+
+	if (bodySetup->AggGeom.GetElementCount() == 0)
+		setupFallbackCollision(mesh, jsonMesh);
+}
+
+void MeshBuilder::setupFallbackCollision(UStaticMesh *mesh, const JsonMesh &jsonMesh){
+	check(mesh && mesh->BodySetup);
+	auto bodySetup = mesh->BodySetup;
+	UE_LOG(JsonLog, Warning, TEXT("Could not generate convex collision for mesh %d(\"%s\"):\nRebuilding as kdop."), (int)jsonMesh.id, *jsonMesh.name);
+	TArray<FVector> verts(KDopDir18, 18);
+	GenerateKDopAsSimpleCollision(mesh, verts);
+	if (bodySetup->AggGeom.GetElementCount() == 0){
+		UE_LOG(JsonLog, Warning, TEXT("Could not generate kdop collision for mesh %d(\"%s\"):\nRebuilding as a box."), (int)jsonMesh.id, *jsonMesh.name);
+		GenerateBoxAsSimpleCollision(mesh);
+	}
+}
+
+/*
+Cooks the convex hulls set up by setupStaticMeshCollision for a batch of meshes in one pass, after all of them are built.
+Cooked data goes through the derived data cache. Meshes whose hull could not be cooked fall back to kdop or box collision.
+*/
+void MeshBuilder::cookConvexCollision(const TArray<ConvexCollisionCook> &cooks){
+	for(const auto &cur: cooks){
+		check(cur.mesh && cur.jsonMesh);
+		auto bodySetup = cur.mesh->BodySetup;
+		if (!bodySetup || (bodySetup->AggGeom.ConvexElems.Num() == 0))
+			continue;
+
+		bodySetup->CreatePhysicsMeshes();
+		bool cooked = true;
+		for(const auto &elem: bodySetup->AggGeom.ConvexElems)
+			cooked = cooked && hasCookedConvexMesh(elem);
+		if (cooked)
+			continue;
+
+		UE_LOG(JsonLog, Warning, TEXT("Convex hull of mesh %d(\"%s\") could not be cooked"), (int)cur.jsonMesh->id, *cur.jsonMesh->name);
+		bodySetup->AggGeom.ConvexElems.Empty();
+		bodySetup->InvalidatePhysicsData();
+		if (bodySetup->AggGeom.GetElementCount() == 0)
+			setupFallbackCollision(cur.mesh, *cur.jsonMesh);
+	}
+}
+
+/*
+Unity uv1 is kept as lightmap uvs when it covers the whole mesh without overlaps, as unity baked lightmaps are laid out in it.
+Otherwise lightmap uvs are generated by the mesh build from uv0 charts into uv1.
+*/
+void MeshBuilder::setupStaticMeshLightmap(UStaticMesh *mesh, FStaticMeshSourceModel &srcModel, const JsonMesh &jsonMesh, 
+		const MeshBuilderUtils::LightmapUvInfo &lightmapUvInfo){
+	check(mesh);
+	mesh->LightMapResolution = lightmapUvInfo.resolution;
+	mesh->LightMapCoordinateIndex = 1;
+
+	auto generate = lightmapUvInfo.needsGeneration();
+	srcModel.BuildSettings.bGenerateLightmapUVs = generate;
+	if (!generate)
+		return;
+
+	srcModel.BuildSettings.SrcLightmapIndex = 0;
+	srcModel.BuildSettings.DstLightmapIndex = 1;
+	srcModel.BuildSettings.MinLightmapResolution = lightmapUvInfo.resolution;
+	if (lightmapUvInfo.hasUvs){
+		UE_LOG(JsonLog, Log, TEXT("Lightmap uvs of mesh %d(\"%s\") will be regenerated. Overlapping: %d, out of range: %d"), 
+			(int)jsonMesh.id, *jsonMesh.name, (int)lightmapUvInfo.overlapping, (int)lightmapUvInfo.outOfRange);
+	}
+}
+
+void MeshBuilder::setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, std::function<void(TArray<FStaticMaterial> &meshMaterial)> materialSetup, 
+		bool renderOnly, const TArray<FVector> *convexHullPoints, const MeshBuilderUtils::LightmapUvInfo *lightmapUvInfo){
 	using namespace UnrealUtilities;
 	using namespace MeshBuilderUtils;
 
@@ -29,8 +163,10 @@ void MeshBuilder::setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, s
 #endif
 
 	mesh->LightingGuid = FGuid::NewGuid();
-	mesh->LightMapResolution = 64;
-	mesh->LightMapCoordinateIndex = 1;
+	if (lightmapUvInfo)
+		setupStaticMeshLightmap(mesh, srcModel, jsonMesh, *lightmapUvInfo);
+	else
+		setupStaticMeshLightmap(mesh, srcModel, jsonMesh, analyzeLightmapUvs(jsonMesh, LightmapUvSettings()));
 
 	FRawMesh newRawMesh;
 	srcModel.RawMeshBulkData->LoadRawMesh(newRawMesh);
@@ -189,42 +325,8 @@ void MeshBuilder::setupStaticMesh(UStaticMesh *mesh, const JsonMesh &jsonMesh, s
 		UE_LOG(JsonLog, Warning, TEXT("Build errors while loading mesh %d(\"%s\"):\n%s"), (int)jsonMesh.id, *jsonMesh.name, *errMsg);
 	}
 	else{
-		TArray<FVector> verts(KDopDir18, 18);
-		GenerateKDopAsSimpleCollision(mesh, verts);
-
-		UBodySetup* bodySetup = mesh->BodySetup;
-		if (!bodySetup || (bodySetup && (bodySetup->AggGeom.GetElementCount() == 0))){
-			UE_LOG(JsonLog, Warning, TEXT("Could not generate convex collision for mesh %d(\"%s\"):\nRebuilding as a box."), (int)jsonMesh.id, *jsonMesh.name);
-			GenerateBoxAsSimpleCollision(mesh);
-		}
-
-		if (bodySetup){
-			/*
-			This is used by imported mesh colliders. 
-			Unity engine allows toggling of collision mesh being/not being convex on the fly, and does not 
-			generate simple collision by default.
-
-			SO if either "convex" or "triangle" flags are set, the importer will adjust collision strategy to mimic unity's.
-
-			Convex will use KDop approach and make the mesh use "simple as complex", while triangular will use 
-			triangular geometry AND mark mesh as "use complex as simple".
-
-			If neither is set, it will use default strategy.
-
-			...
-
-			I wish there was a separation between mesh and collider, though.
-			*/
-			if (jsonMesh.convexCollider){
-				bodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
-			}
-			else if (jsonMesh.triangleCollider){
-				bodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
-			}
-		}
-		if (!bodySetup && (jsonMesh.convexCollider || jsonMesh.triangleCollider)){
-			UE_LOG(JsonLog, Warning, TEXT("Could not setup collision flags for mesh %d(\"%s\") - body setup not generated"), (int)jsonMesh.id, *jsonMesh.name);
-		}
+		auto usage = renderOnly ? CollisionUsage::None: getCollisionUsage(jsonMesh);
+		setupStaticMeshCollision(mesh, jsonMesh, usage, convexHullPoints);
 	}
 
 //#if (ENGINE_MAJOR_VERSION >= 4) && (ENGINE_MINOR_VERSION >= 22)
@@ -2,10 +2,54 @@
 #include "JsonTypes.h"
 #include <functional>
 
+class JsonMesh;
+
 namespace MeshBuilderUtils{
 	void processTangent(int originalIndex, const FloatArray &normFloats, const FloatArray &tangentFloats, bool hasNormals, bool hasTangents,
 		std::function<void(const FVector&)> normCallback, //Receives normal
 		std::function<void(const FVector&, const FVector&)> tanCallback //Receives U and V tangents. U, V. In this order.
 	);
+
+	/*
+	Reduces unity vertex positions to at most maxVerts points on the convex hull, converted to unreal space.
+	Points are extreme vertices along evenly distributed directions, so every returned point lies on the hull.
+	Touches no UObjects and is safe to call from worker threads.
+	*/
+	TArray<FVector> buildConvexHullPoints(const FloatArray &unityVertFloats, int32 maxVerts);
+	const int32 defaultMaxConvexHullVerts = 128;
+
+	/*
+	Lightmap resolution is picked from mesh surface area at unit scale, 
+	components scale it further by their world scale.
+	*/
+	struct LightmapUvSettings{
+		float texelsPerMeter = 16.0f;
+		int32 minResolution = 16;
+		int32 maxResolution = 512;
+		//Fraction of covered texels that may be shared by several triangles before uv1 is considered overlapping.
+		float overlapTolerance = 0.02f;
+		//Overlap is checked on a grid of at most this size, or at the lightmap resolution, whichever is smaller.
+		int32 maxOverlapGridSize = 256;
+
+		int32 getResolution(float surfaceArea, float scale = 1.0f) const;
+	};
+
+	struct LightmapUvInfo{
+		bool hasUvs = false;
+		bool overlapping = false;
+		bool outOfRange = false;
+		float surfaceArea = 0.0f;//In unreal units, squared.
+		int32 resolution = 0;
+
+		bool needsGeneration() const{
+			return !hasUvs || overlapping || outOfRange;
+		}
+	};
+
+	/*
+	Checks whether uv1 of the mesh can be used as lightmap uvs and picks lightmap resolution.
+	Touches no UObjects and is safe to call from worker threads.
+	*/
+	LightmapUvInfo analyzeLightmapUvs(const JsonMesh &jsonMesh, const LightmapUvSettings &settings);
 }
 
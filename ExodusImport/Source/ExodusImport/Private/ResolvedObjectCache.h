@@ -0,0 +1,40 @@
+#pragma once
+#include "JsonTypes.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/*
+Maps ids to objects that were already resolved from their package paths. 
+Entries are weak, so objects that were deleted or collected are resolved again on the next lookup.
+*/
+template<typename Key, typename Res> class ResolvedObjectCache{
+protected:
+	using Map = TMap<Key, TWeakObjectPtr<Res>>;
+	Map map;
+public:
+	void clear(){
+		map.Empty(0);
+	}
+	int num() const{
+		return map.Num();
+	}
+
+	Res* find(const Key &key) const{
+		auto found = map.Find(key);
+		return found ? found->Get(): nullptr;
+	}
+
+	void registerObject(const Key &key, Res *obj){
+		if (obj)
+			map.Add(key, obj);
+		else
+			map.Remove(key);
+	}
+
+	template<typename Loader> Res* findOrLoad(const Key &key, Loader loader){
+		if (auto cached = find(key))
+			return cached;
+		auto loaded = loader();
+		registerObject(key, loaded);
+		return loaded;
+	}
+};
@@ -2,7 +2,9 @@
 #include "TerrainBuilder.h"
 #include "Landscape.h"
 #include "LandscapeInfo.h"
+#include "LandscapeStreamingProxy.h"
 #include "LandscapeLayerInfoObject.h"
+#include "LandscapeDataAccess.h"
 #include "JsonImporter.h"
 
 #include "UnrealUtilities.h"
@@ -11,7 +13,9 @@
 #include "JsonObjects/JsonBinaryTerrain.h"
 
 #include "Runtime/Foliage/Public/InstancedFoliageActor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Runtime/Landscape/Classes/LandscapeGrassType.h"
+#include "Async/ParallelFor.h"
 
 using namespace JsonObjects;
 using namespace UnrealUtilities;
@@ -71,7 +75,7 @@ UStaticMesh* TerrainBuilder::createClonedMesh(const JsonMesh &jsonMesh, const FS
 					for(auto cur: matInstances){
 						meshMaterials.Add(cur);
 					}
-				}
+				}, true
 			);
 		},
 		[&](auto pkg, auto sanitizedName){
@@ -258,40 +262,471 @@ void TerrainBuilder::processFoliageTreeActors(ALandscape *landscape){
 	}
 
 	auto objPos = jsonGameObj.ueWorldMatrix.GetOrigin();
+	const auto numInstances = terrainData.treeInstances.Num();
 
-	for(int instanceIndex = 0; instanceIndex < terrainData.treeInstances.Num(); instanceIndex++){
-		UE_LOG(JsonLogTerrain, Log, TEXT("Processing tree instance %d"), instanceIndex);
-		auto srcInst = terrainData.treeInstances[instanceIndex];
-		auto protoIndex = srcInst.prototypeIndex;
-		auto foundFoliage = foliageTypes.Find(protoIndex);
-		auto *foundMeshInfo = foliageMeshInfos.Find(protoIndex);
-		if (!foundFoliage || !foundMeshInfo){
-			UE_LOG(JsonLogTerrain, Warning, TEXT("Could not find foliage %d for instance %d while processing terrain %s"),
-				protoIndex, instanceIndex, *terrainData.name);
-			continue;
-		}
-		
-		auto meshInfo = *foundMeshInfo;
-		auto foliageType = *foundFoliage;
+	//Transforms are independent from each other, so they're computed on worker threads.
+	TArray<FFoliageInstance> dstInstances;
+	dstInstances.SetNum(numInstances);
+	ParallelFor(numInstances, [&](int32 instanceIndex){
+		const auto &srcInst = terrainData.treeInstances[instanceIndex];
+		auto &dstInst = dstInstances[instanceIndex];
 
 		auto srcPos = srcInst.position;
-		UE_LOG(JsonLogTerrain, Log, TEXT("Src coord %f %f %f"), srcPos.X, srcPos.Y, srcPos.Z);
-
-		FFoliageInstance dstInst;
+		UE_LOG(JsonLogTerrain, Verbose, TEXT("Processing tree instance %d. Src coord %f %f %f"), instanceIndex, srcPos.X, srcPos.Y, srcPos.Z);
 
 		auto scale = FVector(srcInst.widthScale, srcInst.widthScale, srcInst.heightScale);
 
 		dstInst.DrawScale3D = scale * 0.1f; //??why??
 
 		auto treePos = terrainData.getNormalizedPosAsWorld(srcInst.position, objPos);
-		UE_LOG(JsonLogTerrain, Log, TEXT("Dst coord %f %f %f"), treePos.X, treePos.Y, treePos.Z);
+		UE_LOG(JsonLogTerrain, Verbose, TEXT("Tree instance %d. Dst coord %f %f %f"), instanceIndex, treePos.X, treePos.Y, treePos.Z);
 		//Hmm. Instance coordinates are within 0..1 range on terrain. 
 		dstInst.Location = treePos;//unityPosToUe(treePos);
+	});
+
+	//Grouping per foliage type, so each type receives its instances in one batch and its cluster tree is built once.
+	TMap<int32, TArray<const FFoliageInstance*>> instancesPerPrototype;
+	int numMissing = 0;
+	for(int instanceIndex = 0; instanceIndex < numInstances; instanceIndex++){
+		auto protoIndex = terrainData.treeInstances[instanceIndex].prototypeIndex;
+		if (!foliageTypes.Contains(protoIndex) || !foliageMeshInfos.Contains(protoIndex)){
+			UE_LOG(JsonLogTerrain, Verbose, TEXT("Could not find foliage %d for instance %d while processing terrain %s"),
+				protoIndex, instanceIndex, *terrainData.name);
+			numMissing++;
+			continue;
+		}
+		instancesPerPrototype.FindOrAdd(protoIndex).Add(&dstInstances[instanceIndex]);
+	}
+
+	if (numMissing > 0){
+		UE_LOG(JsonLogTerrain, Warning, TEXT("%d tree instances out of %d refer to missing foliage types on terrain %s"),
+			numMissing, numInstances, *terrainData.name);
+	}
+
+	ifa->Modify();
+	for(const auto &cur: instancesPerPrototype){
+		auto meshInfo = foliageMeshInfos[cur.Key];
+		auto foliageType = foliageTypes[cur.Key];
+		const auto &protoInstances = cur.Value;
+		UE_LOG(JsonLogTerrain, Log, TEXT("Adding %d instances of tree prototype %d"), protoInstances.Num(), cur.Key);
+#ifdef EXODUS_UE_VER_4_24_GE
+		meshInfo->AddInstances(ifa, foliageType, protoInstances);
+#elif defined(EXODUS_UE_VER_4_23_GE)
+		for(const auto *curInst: protoInstances){
+			meshInfo->AddInstance(ifa, foliageType, *curInst);
+		}
+#else
+		for(const auto *curInst: protoInstances){
+			meshInfo->AddInstance(ifa, foliageType, *curInst, false);
+		}
+		if (meshInfo->Component){
+			meshInfo->Component->BuildTreeIfOutdated(false, true);
+		}
+#endif
+	}
+}
+
+static bool splatPrototypesMatch(const JsonSplatPrototype &a, const JsonSplatPrototype &b){
+	return (a.textureId == b.textureId) && (a.normalMapId == b.normalMapId)
+		&& (a.metallic == b.metallic) && (a.smoothness == b.smoothness) && (a.specular == b.specular)
+		&& (a.tileOffset == b.tileOffset) && (a.tileSize == b.tileSize);
+}
+
+struct TerrainLayerCoverage{
+	int64 nonZeroTexels = 0;
+	uint8 maxWeight = 0;
+	TBitArray<> usedComponents;
+	int32 numUsedComponents = 0;
+};
+
+/*
+Computes per layer coverage and per component occupancy. 
+Components share their edge vertices, so the edge texels count towards both neighbours.
+*/
+static TArray<TerrainLayerCoverage> gatherLayerCoverage(const TArray<DataPlane2D<uint8>> &layers, uint8 emptyThreshold){
+	TArray<TerrainLayerCoverage> result;
+	result.SetNum(layers.Num());
+	ParallelFor(layers.Num(), [&](int32 layerIndex){
+		const auto &plane = layers[layerIndex];
+		auto &coverage = result[layerIndex];
+		const int32 quadsPerComp = JsonTerrainConstants::quadsPerComponent;
+		const auto compsX = FMath::Max(1, FMath::DivideAndRoundUp(plane.getWidth() - 1, quadsPerComp));
+		const auto compsY = FMath::Max(1, FMath::DivideAndRoundUp(plane.getHeight() - 1, quadsPerComp));
+		coverage.usedComponents.Init(false, compsX * compsY);
+
+		for(int32 y = 0; y < plane.getHeight(); y++){
+			const auto *row = plane.getRow(y);
+			for(int32 x = 0; x < plane.getWidth(); x++){
+				auto weight = row[x];
+				coverage.maxWeight = FMath::Max(coverage.maxWeight, weight);
+				if (weight > emptyThreshold)
+					coverage.nonZeroTexels++;
+			}
+		}
+
+		if (coverage.nonZeroTexels == 0)
+			return;
+
+		for(int32 compY = 0; compY < compsY; compY++){
+			for(int32 compX = 0; compX < compsX; compX++){
+				auto minX = compX * quadsPerComp, minY = compY * quadsPerComp;
+				auto maxX = FMath::Min(minX + quadsPerComp, plane.getWidth() - 1);
+				auto maxY = FMath::Min(minY + quadsPerComp, plane.getHeight() - 1);
+				bool used = false;
+				for(int32 y = minY; !used && (y <= maxY); y++){
+					const auto *row = plane.getRow(y);
+					for(int32 x = minX; x <= maxX; x++){
+						if (row[x] > emptyThreshold){
+							used = true;
+							break;
+						}
+					}
+				}
+				if (used){
+					coverage.usedComponents[compX + compY * compsX] = true;
+					coverage.numUsedComponents++;
+				}
+			}
+		}
+	});
+	return result;
+}
+
+static void logComponentLayers(const TArray<TerrainLayerCoverage> &coverages, const IntArray &layers, const TCHAR *prefix){
+	if (layers.Num() == 0)
+		return;
+	const auto numComponents = coverages[layers[0]].usedComponents.Num();
+	TMap<int32, int32> layerCountHistogram;
+	for(int32 compIndex = 0; compIndex < numComponents; compIndex++){
+		FString layerList;
+		int32 numLayers = 0;
+		for(auto layerIndex: layers){
+			if (!coverages[layerIndex].usedComponents[compIndex])
+				continue;
+			layerList += FString::Printf(TEXT(" %s%d"), prefix, layerIndex);
+			numLayers++;
+		}
+		layerCountHistogram.FindOrAdd(numLayers)++;
+		UE_LOG(JsonLogTerrain, Verbose, TEXT("Component %d uses %d layers:%s"), compIndex, numLayers, *layerList);
+	}
+	layerCountHistogram.KeySort(TLess<int32>());
+	for(const auto &cur: layerCountHistogram){
+		UE_LOG(JsonLogTerrain, Log, TEXT("%d of %d components use %d %slayers"), cur.Value, numComponents, cur.Key, prefix);
+	}
+}
+
+/*
+Merges splat layers with identical prototypes, drops splat and detail layers that have no weight anywhere
+and reports which components need which layers. Weights of merged splats are added together.
+*/
+void TerrainBuilder::analyzeLayerUsage(JsonConvertedTerrain &convertedTerrain){
+	layerUsage = TerrainLayerUsage();
+	auto &alphaMaps = convertedTerrain.alphaMaps;
+	auto &detailMaps = convertedTerrain.detailMaps;
+
+	if (alphaMaps.Num() != terrainData.splatPrototypes.Num()){
+		UE_LOG(JsonLogTerrain, Warning, TEXT("Terrain \"%s\" has %d alpha maps and %d splat prototypes"), 
+			*terrainData.name, alphaMaps.Num(), terrainData.splatPrototypes.Num());
+	}
+	const auto numSplats = FMath::Min(alphaMaps.Num(), terrainData.splatPrototypes.Num());
+
+	IntArray splatTargets;
+	splatTargets.SetNum(numSplats);
+	for(int i = 0; i < numSplats; i++){
+		splatTargets[i] = i;
+		if (!settings.mergeIdenticalSplats)
+			continue;
+		for(int j = 0; j < i; j++){
+			if ((splatTargets[j] == j) && splatPrototypesMatch(terrainData.splatPrototypes[i], terrainData.splatPrototypes[j])){
+				splatTargets[i] = j;
+				break;
+			}
+		}
+	}
+
+	for(int i = 0; i < numSplats; i++){
+		auto target = splatTargets[i];
+		if (target == i)
+			continue;
+		UE_LOG(JsonLogTerrain, Log, TEXT("Splat layer %d is identical to layer %d, merging"), i, target);
+		auto &dst = alphaMaps[target].getArray();
+		auto &src = alphaMaps[i].getArray();
+		check(dst.Num() == src.Num());
+		for(int32 texel = 0; texel < dst.Num(); texel++){
+			dst[texel] = FMath::Min(0xFF, dst[texel] + src[texel]);
+		}
+		alphaMaps[i].clear();
+	}
+
+	auto splatCoverage = gatherLayerCoverage(alphaMaps, settings.emptyLayerThreshold);
+	auto detailCoverage = gatherLayerCoverage(detailMaps, settings.emptyLayerThreshold);
+
+	const auto numTexels = FMath::Max((int64)convertedTerrain.heightMap.getNumElements(), (int64)1);
+	for(int i = 0; i < numSplats; i++){
+		if (splatTargets[i] != i)
+			continue;
+		const auto &coverage = splatCoverage[i];
+		UE_LOG(JsonLogTerrain, Log, TEXT("Splat layer %d: coverage %.2f%%, max weight %d, used by %d of %d components"), 
+			i, 100.0 * (double)coverage.nonZeroTexels / (double)numTexels, (int)coverage.maxWeight, 
+			coverage.numUsedComponents, coverage.usedComponents.Num());
+		if (coverage.nonZeroTexels > 0)
+			layerUsage.splatLayers.Add(i);
+		else
+			UE_LOG(JsonLogTerrain, Log, TEXT("Splat layer %d is empty and will not be imported"), i);
+	}
+	//The material needs at least one layer to sample.
+	if ((layerUsage.splatLayers.Num() == 0) && (numSplats > 0))
+		layerUsage.splatLayers.Add(0);
+
+	for(int i = 0; i < detailMaps.Num(); i++){
+		const auto &coverage = detailCoverage[i];
+		UE_LOG(JsonLogTerrain, Log, TEXT("Detail layer %d: coverage %.2f%%, max density %d, used by %d of %d components"), 
+			i, 100.0 * (double)coverage.nonZeroTexels / (double)numTexels, (int)coverage.maxWeight, 
+			coverage.numUsedComponents, coverage.usedComponents.Num());
+		if (coverage.nonZeroTexels > 0)
+			layerUsage.detailLayers.Add(i);
+		else
+			UE_LOG(JsonLogTerrain, Log, TEXT("Detail layer %d is empty and will not be imported"), i);
+	}
+
+	UE_LOG(JsonLogTerrain, Log, TEXT("Terrain \"%s\": %d of %d splat layers and %d of %d detail layers kept"), 
+		*terrainData.name, layerUsage.splatLayers.Num(), terrainData.splatPrototypes.Num(), 
+		layerUsage.detailLayers.Num(), detailMaps.Num());
+	logComponentLayers(splatCoverage, layerUsage.splatLayers, TEXT("Layer"));
+	logComponentLayers(detailCoverage, layerUsage.detailLayers, TEXT("GrassLayer"));
+}
+
+static float sampleLandscapeHeight(const DataPlane2D<uint16> &heightMap, float x, float y){
+	auto x0 = FMath::Clamp(FMath::FloorToInt(x), 0, heightMap.getWidth() - 1);
+	auto y0 = FMath::Clamp(FMath::FloorToInt(y), 0, heightMap.getHeight() - 1);
+	auto x1 = FMath::Min(x0 + 1, heightMap.getWidth() - 1);
+	auto y1 = FMath::Min(y0 + 1, heightMap.getHeight() - 1);
+	auto fx = FMath::Clamp(x - (float)x0, 0.0f, 1.0f);
+	auto fy = FMath::Clamp(y - (float)y0, 0.0f, 1.0f);
+	auto h = FMath::BiLerp((float)heightMap.getValue(x0, y0), (float)heightMap.getValue(x1, y0), 
+		(float)heightMap.getValue(x0, y1), (float)heightMap.getValue(x1, y1), fx, fy);
+	return (h - 32768.0f) * LANDSCAPE_ZSCALE;
+}
+
+/*
+Scatters detail meshes according to unity per-cell detail counts and stores them in hierarchical instanced
+mesh components. Each cluster of landscape components gets its own actor, so the instances stream and cull 
+together with the terrain area they belong to.
+*/
+void TerrainBuilder::processDetailInstances(const DataPlane2D<uint16> &heightMap, const TArray<DataPlane2D<int32>> &detailDensities, 
+		const FTransform &terrainTransform, const FString &terrainDataPath){
+	const auto numLayers = FMath::Min(detailDensities.Num(), terrainData.detailPrototypes.Num());
+	UE_LOG(JsonLogTerrain, Log, TEXT("Converting %d detail layers to instances"), numLayers);
+	if ((numLayers <= 0) || heightMap.isEmpty())
+		return;
+
+	const auto quadsX = heightMap.getWidth() - 1;
+	const auto quadsY = heightMap.getHeight() - 1;
+	const auto clusterQuads = FMath::Max(settings.detailClusterComponents, 1) * (int32)JsonTerrainConstants::quadsPerComponent;
+	const auto clustersX = FMath::Max(FMath::DivideAndRoundUp(quadsX, clusterQuads), 1);
+	const auto clustersY = FMath::Max(FMath::DivideAndRoundUp(quadsY, clusterQuads), 1);
+	const auto densityScale = jsonTerrain.detailObjectDensity * settings.detailDensityScale;
+
+	//[layer][cluster] -> world transforms
+	TArray<TArray<TArray<FTransform>>> layerClusters;
+	layerClusters.SetNum(numLayers);
+	ParallelFor(numLayers, [&](int32 layerIndex){
+		const auto &density = detailDensities[layerIndex];
+		const auto &prototype = terrainData.detailPrototypes[layerIndex];
+		auto &clusters = layerClusters[layerIndex];
+		clusters.SetNum(clustersX * clustersY);
+		if (density.isEmpty())
+			return;
+
+		FRandomStream random(layerIndex + 1);
+		const auto cellToQuadX = (float)quadsX / (float)density.getWidth();
+		const auto cellToQuadY = (float)quadsY / (float)density.getHeight();
+		for(int32 cellY = 0; cellY < density.getHeight(); cellY++){
+			for(int32 cellX = 0; cellX < density.getWidth(); cellX++){
+				auto count = (float)FMath::Clamp(density.getValue(cellX, cellY), 0, 16) * densityScale;
+				auto numInstances = FMath::FloorToInt(count);
+				if (random.FRand() < (count - (float)numInstances))
+					numInstances++;
+
+				for(int32 i = 0; i < numInstances; i++){
+					auto quadX = ((float)cellX + random.FRand()) * cellToQuadX;
+					auto quadY = ((float)cellY + random.FRand()) * cellToQuadY;
+					auto localPos = FVector(quadX, quadY, sampleLandscapeHeight(heightMap, quadX, quadY));
+
+					auto width = random.FRandRange(prototype.minWidth, prototype.maxWidth);
+					auto height = random.FRandRange(prototype.minHeight, prototype.maxHeight);
+					auto rotation = FRotator(0.0f, random.FRandRange(0.0f, 360.0f), 0.0f);
+
+					auto clusterX = FMath::Clamp(FMath::FloorToInt(quadX) / clusterQuads, 0, clustersX - 1);
+					auto clusterY = FMath::Clamp(FMath::FloorToInt(quadY) / clusterQuads, 0, clustersY - 1);
+					clusters[clusterX + clusterY * clustersX].Add(FTransform(
+						rotation.Quaternion(), terrainTransform.TransformPosition(localPos), FVector(width, width, height)
+					));
+				}
+			}
+		}
+	});
+
+	TArray<UStaticMesh*> layerMeshes;
+	for(int layerIndex = 0; layerIndex < numLayers; layerIndex++){
+		const auto &prototype = terrainData.detailPrototypes[layerIndex];
+		UStaticMesh *mesh = nullptr;
+		bool hasInstances = false;
+		for(const auto &cluster: layerClusters[layerIndex])
+			hasInstances = hasInstances || (cluster.Num() > 0);
+		if (hasInstances){
+			auto meshName = terrainData.getGrassTypeName(layerIndex) + (prototype.usePrototypeMesh ? TEXT("mesh"): TEXT("_Mesh"));
+			mesh = prototype.usePrototypeMesh ? 
+				createGrassMesh(meshName, prototype, layerIndex, terrainDataPath):
+				createBillboardMesh(meshName, prototype, layerIndex, terrainDataPath);
+			if (!mesh)
+				UE_LOG(JsonLogTerrain, Warning, TEXT("Could not create mesh for detail layer %d"), layerIndex);
+		}
+		layerMeshes.Add(mesh);
+	}
+
+	const auto cullDistance = unityDistanceToUe(jsonTerrain.detailObjectDistance);
+	int32 totalInstances = 0;
+	detailActors.Empty();
+	for(int32 clusterY = 0; clusterY < clustersY; clusterY++){
+		for(int32 clusterX = 0; clusterX < clustersX; clusterX++){
+			auto clusterIndex = clusterX + clusterY * clustersX;
+			AActor *clusterActor = nullptr;
+			for(int layerIndex = 0; layerIndex < numLayers; layerIndex++){
+				const auto &instances = layerClusters[layerIndex][clusterIndex];
+				auto mesh = layerMeshes[layerIndex];
+				if (!mesh || (instances.Num() == 0))
+					continue;
+
+				if (!clusterActor){
+					auto clusterCenter = FVector(
+						FMath::Min((clusterX + 0.5f) * clusterQuads, (float)quadsX), 
+						FMath::Min((clusterY + 0.5f) * clusterQuads, (float)quadsY), 0.0f);
+					auto actorTransform = FTransform(terrainTransform.TransformPosition(clusterCenter));
+					clusterActor = workData.world->SpawnActor<AActor>(AActor::StaticClass(), actorTransform);
+					auto rootComponent = NewObject<USceneComponent>(clusterActor);
+					rootComponent->SetWorldTransform(actorTransform);
+					rootComponent->SetMobility(EComponentMobility::Static);
+					clusterActor->SetRootComponent(rootComponent);
+					clusterActor->SetActorLabel(FString::Printf(TEXT("%s_details_%d_%d"), *jsonGameObj.ueName, clusterX, clusterY), true);
+					detailActors.Add(clusterActor);
+				}
+
+				auto hism = NewObject<UHierarchicalInstancedStaticMeshComponent>(clusterActor);
+				hism->SetStaticMesh(mesh);
+				hism->SetMobility(EComponentMobility::Static);
+				hism->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+				hism->SetCastShadow(!terrainData.detailPrototypes[layerIndex].billboardFlag);
+				hism->InstanceEndCullDistance = FMath::RoundToInt(cullDistance);
+				hism->bAutoRebuildTreeOnInstanceChanges = false;
+				hism->SetupAttachment(clusterActor->GetRootComponent());
+
+				const auto actorTransform = clusterActor->GetActorTransform();
+				hism->PerInstanceSMData.Reserve(instances.Num());
+				for(const auto &cur: instances){
+					hism->AddInstance(cur.GetRelativeTransform(actorTransform));
+				}
+				hism->BuildTreeIfOutdated(false, true);
+				clusterActor->AddInstanceComponent(hism);
+				hism->RegisterComponent();
+				totalInstances += instances.Num();
+			}
+		}
+	}
+
+	UE_LOG(JsonLogTerrain, Log, TEXT("Created %d detail instances in %d cluster actors"), totalInstances, detailActors.Num());
+}
+
+void TerrainBuilder::importLandscapeRegion(ALandscapeProxy *proxy, const FGuid &landscapeGuid, 
+		const JsonConvertedTerrain &convertedTerrain, const TArray<FLandscapeImportLayerInfo> &layerInfos, 
+		const TArray<const DataPlane2D<uint8>*> &layerSources, 
+		int32 minX, int32 minY, int32 maxX, int32 maxY, int32 sectionsPerComp, int32 quadsPerSection){
+	check(proxy);
+	check(layerInfos.Num() == layerSources.Num());
+
+	const auto& heightMapData = convertedTerrain.heightMap;
+	const bool wholeMap = (minX == 0) && (minY == 0) 
+		&& (maxX == heightMapData.getWidth() - 1) && (maxY == heightMapData.getHeight() - 1);
+
+	auto getRegion = [&](const auto &plane){
+		return wholeMap ? plane.getArrayCopy(): plane.getRegionArray(minX, minY, maxX, maxY);
+	};
+
 #if (ENGINE_MAJOR_VERSION == 4) && (ENGINE_MINOR_VERSION >= 23)
-		meshInfo->AddInstance(ifa, foliageType, dstInst);
+	TMap<FGuid, TArray<FLandscapeImportLayerInfo>> importLayerMap;
+	auto& importLayers = importLayerMap.Add(FGuid());
 #else
-		meshInfo->AddInstance(ifa, foliageType, dstInst, true);
+	TArray<FLandscapeImportLayerInfo> importLayers;
 #endif
+	importLayers = layerInfos;
+	for(int i = 0; i < importLayers.Num(); i++){
+		importLayers[i].LayerData = getRegion(*layerSources[i]);
+	}
+
+#if (ENGINE_MAJOR_VERSION == 4) && (ENGINE_MINOR_VERSION >= 23)
+	TMap<FGuid, TArray<uint16>> heightLayerData;
+	heightLayerData.Add(FGuid(), getRegion(heightMapData));
+	proxy->Import(landscapeGuid,
+		minX, minY, maxX, maxY, sectionsPerComp, quadsPerSection,
+		heightLayerData, TEXT(""),
+		importLayerMap, ELandscapeImportAlphamapType::Additive);
+#else
+	auto heightData = getRegion(heightMapData);
+	proxy->Import(landscapeGuid,
+		minX, minY, maxX, maxY, sectionsPerComp, quadsPerSection, 
+		heightData.GetData(), TEXT(""), 
+		importLayers, ELandscapeImportAlphamapType::Additive);
+#endif
+}
+
+/*
+Splits the landscape components into component-aligned tiles. The first tile goes into the landscape actor itself,
+the rest are imported into streaming proxies sharing its guid. All proxies stay in the current level.
+Import buffers are copied one tile at a time, but the converted height and layer planes of the whole terrain 
+stay in memory until every tile is done.
+*/
+void TerrainBuilder::importLandscapeTiles(ALandscape *landscape, const FGuid &landscapeGuid, 
+		const JsonConvertedTerrain &convertedTerrain, const TArray<FLandscapeImportLayerInfo> &layerInfos, 
+		const TArray<const DataPlane2D<uint8>*> &layerSources, 
+		const FTransform &terrainTransform, int32 sectionsPerComp, int32 quadsPerSection){
+	check(landscape);
+	const auto& heightMapData = convertedTerrain.heightMap;
+	const auto quadsX = heightMapData.getWidth() - 1;
+	const auto quadsY = heightMapData.getHeight() - 1;
+	const auto quadsPerComp = sectionsPerComp * quadsPerSection;
+	check(quadsPerComp == JsonTerrainConstants::quadsPerComponent);
+	const auto quadsPerTile = FMath::Max(settings.componentsPerTile, 1) * quadsPerComp;
+
+	const auto numTilesX = FMath::DivideAndRoundUp(quadsX, quadsPerTile);
+	const auto numTilesY = FMath::DivideAndRoundUp(quadsY, quadsPerTile);
+
+	streamingProxies.Empty();
+	for(int32 tileY = 0; tileY < numTilesY; tileY++){
+		for(int32 tileX = 0; tileX < numTilesX; tileX++){
+			auto minX = tileX * quadsPerTile;
+			auto minY = tileY * quadsPerTile;
+			auto maxX = FMath::Min(minX + quadsPerTile, quadsX);
+			auto maxY = FMath::Min(minY + quadsPerTile, quadsY);
+			UE_LOG(JsonLogTerrain, Log, TEXT("Importing terrain tile %d, %d: %d %d - %d %d"), tileX, tileY, minX, minY, maxX, maxY);
+
+			ALandscapeProxy *tileProxy = landscape;
+			if ((tileX != 0) || (tileY != 0)){
+				auto streamingProxy = workData.world->SpawnActor<ALandscapeStreamingProxy>();
+				streamingProxy->LandscapeActor = landscape;
+				streamingProxy->LandscapeMaterial = landscape->LandscapeMaterial;
+				streamingProxy->LandscapeHoleMaterial = landscape->LandscapeHoleMaterial;
+				streamingProxy->StaticLightingLOD = landscape->StaticLightingLOD;
+				streamingProxy->SetActorLabel(FString::Printf(TEXT("%s_tile_%d_%d"), *jsonGameObj.ueName, tileX, tileY));
+				streamingProxies.Add(streamingProxy);
+				tileProxy = streamingProxy;
+			}
+
+			importLandscapeRegion(tileProxy, landscapeGuid, convertedTerrain, layerInfos, layerSources,
+				minX, minY, maxX, maxY, sectionsPerComp, quadsPerSection);
+
+			if (tileProxy != landscape)
+				tileProxy->SetActorTransform(terrainTransform);
+		}
 	}
 }
 
@@ -310,6 +745,18 @@ ALandscape* TerrainBuilder::buildTerrain(){
 	JsonConvertedTerrain convertedTerrain;
 	convertedTerrain.assignFrom(binaryTerrain);
 
+	//Raw per-cell detail counts. When details become instances, they don't need grass layers.
+	TArray<DataPlane2D<int32>> detailDensities;
+	if (settings.detailsAsInstances){
+		for(int i = 0; i < binaryTerrain.detailMaps.getNumLayers(); i++){
+			auto &density = detailDensities.AddDefaulted_GetRef();
+			binaryTerrain.detailMaps.getLayerData(density, i);
+			density.transpose();
+		}
+		convertedTerrain.detailMaps.Empty();
+	}
+	binaryTerrain.clear();//Float source data is no longer needed.
+
 	const auto& heightMapData = convertedTerrain.heightMap;
 
 	ALandscape * result = nullptr;
@@ -324,23 +771,22 @@ ALandscape* TerrainBuilder::buildTerrain(){
 	xSize = heightMapData.getWidth();
 	ySize = heightMapData.getHeight();
 
+	analyzeLayerUsage(convertedTerrain);
+
 	//normal layers
-#if (ENGINE_MAJOR_VERSION == 4) && (ENGINE_MINOR_VERSION >= 23)
-	TMap<FGuid, TArray<FLandscapeImportLayerInfo>> importLayerMap;
-	auto& importLayers = importLayerMap.Add(FGuid());
-#else
+	//Layer data is filled in per imported region, layerSources point to the full converted planes.
 	TArray<FLandscapeImportLayerInfo> importLayers;
-#endif
+	TArray<const DataPlane2D<uint8>*> layerSources;
 	if (convertedTerrain.alphaMaps.Num() > 0){
-		for(int i = 0; i < convertedTerrain.alphaMaps.Num(); i++){
+		for(auto i: layerUsage.splatLayers){
 			auto layerName = terrainData.getLayerName(i);
 			auto layerInfoObj = createTerrainLayerInfo(i, false, terrainDataPath);
 
 			auto &newLayer = importLayers.AddDefaulted_GetRef();
 			newLayer.LayerName = *layerName;
-			newLayer.LayerData = convertedTerrain.alphaMaps[i].getArrayCopy();
 			newLayer.LayerInfo = layerInfoObj;
 			newLayer.SourceFilePath = TEXT("");
+			layerSources.Add(&convertedTerrain.alphaMaps[i]);
 		}
 	}
 
@@ -350,15 +796,20 @@ ALandscape* TerrainBuilder::buildTerrain(){
 	grassTypes.Empty();
 	if (convertedTerrain.detailMaps.Num() > 0){
 		for(int i = 0; i < convertedTerrain.detailMaps.Num(); i++){
+			//Grass types stay indexed by detail prototype, empty layers get none.
+			if (!layerUsage.isDetailLayerUsed(i)){
+				grassTypes.Add(nullptr);
+				continue;
+			}
 			auto layerName = terrainData.getGrassLayerName(i);
 			auto layerInfoObj = createTerrainLayerInfo(i, true, terrainDataPath);
 
 			auto &newLayer = importLayers.AddDefaulted_GetRef();
 			newLayer.LayerName = *layerName;
 			auto& detail = convertedTerrain.detailMaps[i];
-			newLayer.LayerData = detail.getArrayCopy();
 			newLayer.LayerInfo = layerInfoObj;
 			newLayer.SourceFilePath = TEXT("");
+			layerSources.Add(&detail);
 		#ifdef TERRAIN_SAVE_DEBUG_IMAGES
 			auto fullDstPath = FPaths::Combine(TEXT("D:\\work\\EpicGames\\debug"), layerName + FString::Printf(TEXT("_%dx%d"), xSize, ySize) + TEXT(".raw"));
 			detail.saveToRaw(fullDstPath);
@@ -368,6 +819,8 @@ ALandscape* TerrainBuilder::buildTerrain(){
 			grassTypes.Add(newGrassType);
 		}
 	}
+	if (settings.detailsAsInstances)
+		grassTypes.Init(nullptr, terrainData.detailPrototypes.Num());
 
 	auto terrainVertSize = FIntPoint(xSize, ySize);
 	MaterialBuilder materialBuilder;
@@ -433,19 +886,16 @@ ALandscape* TerrainBuilder::buildTerrain(){
 	landProxy->LandscapeMaterial = terrainMaterial;
 	landProxy->LandscapeHoleMaterial = terrainMaterial;
 
-#if (ENGINE_MAJOR_VERSION == 4) && (ENGINE_MINOR_VERSION >= 23)
-	TMap<FGuid, TArray<uint16>> heightLayerData;
-	heightLayerData.Add(FGuid(), heightMapData.getArray());//Ouch. Need optimization, excessive copying here.
-	landProxy->Import(FGuid::NewGuid(),
-		0, 0, xSize - 1, ySize - 1, sectionsPerComp, quadsPerSection,
-		heightLayerData, TEXT(""),
-		importLayerMap, ELandscapeImportAlphamapType::Additive);
-#else
-	landProxy->Import(FGuid::NewGuid(),
-		0, 0, xSize - 1, ySize - 1, sectionsPerComp, quadsPerSection, 
-		heightMapData.getData(), TEXT(""), 
-		importLayers, ELandscapeImportAlphamapType::Additive);
-#endif
+	auto maxSize = FMath::Max(xSize, ySize);
+	if ((settings.tiledImportMinSize > 0) && (maxSize > settings.tiledImportMinSize)){
+		UE_LOG(JsonLogTerrain, Log, TEXT("Terrain is %d x %d, splitting components into tiles of %d x %d components"), 
+			xSize, ySize, settings.componentsPerTile, settings.componentsPerTile);
+		importLandscapeTiles(result, guid, convertedTerrain, importLayers, layerSources, terrainTransform, sectionsPerComp, quadsPerSection);
+	}
+	else{
+		importLandscapeRegion(landProxy, guid, convertedTerrain, importLayers, layerSources, 
+			0, 0, xSize - 1, ySize - 1, sectionsPerComp, quadsPerSection);
+	}
 
 	for(int i = 0; i < importLayers.Num(); i++){
 		auto &curLayer = importLayers[i];
@@ -453,11 +903,16 @@ ALandscape* TerrainBuilder::buildTerrain(){
 	}
 
 	ULandscapeInfo *landscapeInfo  = result->CreateLandscapeInfo();
+	for(auto curProxy: streamingProxies){
+		curProxy->CreateLandscapeInfo();
+	}
 	landscapeInfo->UpdateLayerInfoMap(result);
 
 	result->SetActorTransform(terrainTransform);
 
 	processFoliageTreeActors(result);
+	if (settings.detailsAsInstances)
+		processDetailInstances(convertedTerrain.heightMap, detailDensities, terrainTransform, terrainDataPath);
 
 	if (terrainData.detailPrototypes.Num() > 0){
 		//landProxy->FlushGrassComponents();
@@ -5,21 +5,78 @@
 #include "JsonObjects/JsonTerrain.h"
 #include "JsonObjects/JsonTerrainData.h"
 #include "ImportContext.h"
+#include "JsonObjects/DataPlane2D.h"
 
 class JsonImporter;
 class ALandscape;
+class ALandscapeProxy;
+class ALandscapeStreamingProxy;
+struct FLandscapeImportLayerInfo;
+class JsonConvertedTerrain;
 class ULandscapeGrassType;
 class ULandscapeLayerInfoObject;
 class UStaticMesh;
 class UMaterialInstanceConstant;
 
+struct TerrainImportSettings{
+	/*
+	Terrains with more vertices per side than this are split into component-aligned tiles, 
+	each imported into its own streaming proxy. 0 disables tiled import (default).
+	This only splits the components between proxy actors. All proxies are spawned in the persistent level,
+	and the whole converted terrain is kept in memory during import, so it is neither a memory nor a streaming fix.
+	Proxies can be moved into sublevels manually afterwards.
+	*/
+	int32 tiledImportMinSize = 0;
+	int32 componentsPerTile = 8;
+
+	//Layers whose weights never exceed this value are treated as empty and are not imported.
+	uint8 emptyLayerThreshold = 0;
+	//Splat prototypes with identical textures and parameters are merged into a single layer.
+	bool mergeIdenticalSplats = true;
+
+	/*
+	Terrains with at least this many splat layers pack their albedo and normal maps into texture arrays,
+	so the material uses a fixed number of samplers. 0 disables texture arrays. Requires 4.25 or later.
+	*/
+	int32 textureArrayMinLayers = 8;
+
+	/*
+	Detail layers are converted into precomputed instanced meshes instead of landscape grass layers.
+	Instances are grouped into actors covering detailClusterComponents x detailClusterComponents landscape components,
+	aligned to the landscape component grid. The default gives one actor per component.
+	Turning it off brings back landscape grass types.
+	*/
+	bool detailsAsInstances = true;
+	int32 detailClusterComponents = 1;
+	float detailDensityScale = 1.0f;
+};
+
+/*
+Result of the layer analysis pass. Indexes refer to source splat and detail prototypes.
+*/
+struct TerrainLayerUsage{
+	IntArray splatLayers;//source splats that get a landscape layer and a material blend entry
+	IntArray detailLayers;//source detail layers that get a landscape layer and a grass type
+
+	bool isSplatLayerUsed(int index) const{
+		return splatLayers.Contains(index);
+	}
+	bool isDetailLayerUsed(int index) const{
+		return detailLayers.Contains(index);
+	}
+};
+
 class TerrainBuilder{
 protected:
 	JsonImporter *importer = nullptr;
 	ImportContext &workData;
 	//FString terrainDataPath;
 public:
+	TerrainImportSettings settings;
+	TerrainLayerUsage layerUsage;
 	TArray<ULandscapeGrassType*> grassTypes;
+	TArray<ALandscapeStreamingProxy*> streamingProxies;
+	TArray<AActor*> detailActors;
 	const JsonGameObject &jsonGameObj;
 	const JsonTerrain &jsonTerrain;
 	const JsonTerrainData &terrainData;
@@ -49,6 +106,18 @@ protected:
 	ULandscapeLayerInfoObject* createTerrainLayerInfo(int layerIndex, bool grassLayer, 
 		const FString &terrainDataPath);
 	void processFoliageTreeActors(ALandscape *landscape);
+	void analyzeLayerUsage(JsonConvertedTerrain &convertedTerrain);
+	void processDetailInstances(const DataPlane2D<uint16> &heightMap, const TArray<DataPlane2D<int32>> &detailDensities, 
+		const FTransform &terrainTransform, const FString &terrainDataPath);
+
+	void importLandscapeRegion(ALandscapeProxy *proxy, const FGuid &landscapeGuid, 
+		const JsonConvertedTerrain &convertedTerrain, const TArray<FLandscapeImportLayerInfo> &layerInfos, 
+		const TArray<const DataPlane2D<uint8>*> &layerSources, 
+		int32 minX, int32 minY, int32 maxX, int32 maxY, int32 sectionsPerComp, int32 quadsPerSection);
+	void importLandscapeTiles(ALandscape *landscape, const FGuid &landscapeGuid, 
+		const JsonConvertedTerrain &convertedTerrain, const TArray<FLandscapeImportLayerInfo> &layerInfos, 
+		const TArray<const DataPlane2D<uint8>*> &layerSources, 
+		const FTransform &terrainTransform, int32 sectionsPerComp, int32 quadsPerSection);
 
 	UStaticMesh* createBillboardMesh(const FString &baseName, const JsonTerrainDetailPrototype &detPrototype, int layerIndex, const FString &terrainDataPath);
 	UStaticMesh* createGrassMesh(const FString &baseName, const JsonTerrainDetailPrototype &detPrototype, int layerIndex, const FString &terrainDataPath);
@@ -0,0 +1,139 @@
+#include "JsonImportPrivatePCH.h"
+#include "TextureImportPolicy.h"
+#include "JsonObjects/JsonTexture.h"
+#include "JsonObjects/JsonMaterial.h"
+#include "Factories/TextureFactory.h"
+
+bool TextureImportPolicy::isLegacyNormalMapName(const FString &name){
+	return name.EndsWith(FString("_n")) || name.EndsWith(FString("Normals"));
+}
+
+void TextureImportPolicy::gatherUsage(const JsonMaterial &jsonMat, bool baseMaterialInstance){
+	auto addUsage = [&](JsonTextureId texId, uint32 flags){
+		if (texId < 0)
+			return;
+		textureUsage.FindOrAdd(texId) |= flags | (baseMaterialInstance ? UsageBaseMaterial: 0);
+	};
+
+	addUsage(jsonMat.albedoTex, UsageColor);
+	addUsage(jsonMat.detailAlbedoTex, UsageColor);
+	//rgb of the specular map is color, alpha is smoothness.
+	addUsage(jsonMat.specularTex, UsageColor);
+	addUsage(jsonMat.emissionTex, UsageEmission);
+	addUsage(jsonMat.normalMapTex, UsageNormal);
+	addUsage(jsonMat.detailNormalMapTex, UsageNormal);
+	//metallic in r, smoothness in a.
+	addUsage(jsonMat.metallicTex, UsageMask);
+	addUsage(jsonMat.occlusionTex, UsageGrayscale);
+	addUsage(jsonMat.parallaxTex, UsageGrayscale);
+	addUsage(jsonMat.detailMaskTex, UsageGrayscale);
+}
+
+TextureImportPolicy::Decision TextureImportPolicy::decide(const JsonTexture &jsonTex) const{
+	Decision result;
+	const auto &importParams = jsonTex.textureImportParams;
+	bool hasImportParams = jsonTex.importDataFound && importParams.initialized;
+	const auto &textureType = hasImportParams ? importParams.textureType: jsonTex.textureType;
+	auto usage = getUsage(jsonTex.id);
+	bool colorUsage = (usage & (UsageColor | UsageEmission)) != 0;
+
+	result.srgb = hasImportParams ? importParams.sRGBTexture: jsonTex.sRGB;
+
+	if ((textureType == TEXT("GUI")) || (textureType == TEXT("Sprite")) || (textureType == TEXT("Cursor"))){
+		result.lodGroup = TEXTUREGROUP_UI;
+		result.compression = TC_EditorIcon;
+		result.noMipmaps = true;
+		result.reason = TEXT("ui");
+	}
+	else if (textureType == TEXT("Lightmap")){
+		result.lodGroup = TEXTUREGROUP_Lightmap;
+		auto ext = FPaths::GetExtension(jsonTex.path).ToLower();
+		if ((ext == TEXT("exr")) || (ext == TEXT("hdr"))){
+			result.compression = TC_HDR;
+			result.srgb = false;
+		}
+		result.reason = TEXT("lightmap");
+	}
+	else if ((textureType == TEXT("NormalMap")) || (jsonTex.importDataFound && jsonTex.normalMapFlag)
+			|| ((usage & UsageNormal) && !colorUsage) || ((usage == 0) && isLegacyNormalMapName(jsonTex.name))){
+		result.normalMap = true;
+		result.lodGroup = TEXTUREGROUP_WorldNormalMap;
+		result.compression = TC_Normalmap;
+		result.srgb = false;
+		result.reason = TEXT("normal map");
+	}
+	else if ((usage != 0) && !colorUsage && !(usage & UsageNormal)){
+		/*
+		Data maps bound to the color samplers of the shipped base materials keep default compression.
+		Grayscale compression would keep only the red channel, while unity reads occlusion and height from green and detail mask from alpha.
+		*/
+		result.lodGroup = TEXTUREGROUP_WorldSpecular;
+		if (usage & UsageBaseMaterial){
+			result.reason = TEXT("base material mask");
+		}
+		else{
+			result.compression = TC_Masks;
+			result.srgb = false;
+			result.reason = (usage & UsageMask) ? TEXT("mask"): TEXT("grayscale mask");
+		}
+	}
+	else if ((usage == 0) && (textureType == TEXT("SingleChannel"))){
+		result.compression = TC_Grayscale;
+		result.reason = TEXT("single channel");
+	}
+	else if (hasImportParams && (importParams.textureCompression == TEXT("CompressedHQ"))){
+		result.compression = TC_BC7;
+		result.reason = TEXT("high quality color");
+	}
+	else if (colorUsage){
+		result.reason = TEXT("color");
+	}
+
+	//Texture samplers of the shipped base materials are color samplers, which reject linear textures.
+	if ((usage & UsageBaseMaterial) && !result.normalMap && (result.compression != TC_HDR))
+		result.srgb = true;
+
+	if (hasImportParams){
+		if (importParams.textureCompression == TEXT("Uncompressed"))
+			result.noCompression = true;
+		if (!importParams.mipmapEnabled)
+			result.noMipmaps = true;
+	}
+	//Textures without mips cannot be streamed.
+	result.neverStream = result.noMipmaps;
+
+	int32 sizeLimit = settings.maxTextureSize;
+	if (settings.useUnityMaxTextureSize && hasImportParams && (importParams.maxTextureSize > 0))
+		sizeLimit = (sizeLimit > 0) ? FMath::Min(sizeLimit, importParams.maxTextureSize): importParams.maxTextureSize;
+	if ((sizeLimit > 0) && (FMath::Max(jsonTex.width, jsonTex.height) > sizeLimit))
+		result.maxTextureSize = sizeLimit;
+
+	return result;
+}
+
+void TextureImportPolicy::applyToFactory(UTextureFactory *factory, const Decision &decision){
+	check(factory);
+	factory->LODGroup = decision.lodGroup;
+	factory->CompressionSettings = decision.compression;
+	factory->MipGenSettings = decision.noMipmaps ? TMGS_NoMipmaps: TMGS_FromTextureGroup;
+	factory->NoCompression = decision.noCompression;
+}
+
+bool TextureImportPolicy::applyToTexture(UTexture *texture, const Decision &decision){
+	check(texture);
+	bool rebuild = false;
+	if (texture->SRGB != decision.srgb){
+		texture->SRGB = decision.srgb;
+		rebuild = true;
+	}
+	if (texture->MaxTextureSize != decision.maxTextureSize){
+		texture->MaxTextureSize = decision.maxTextureSize;
+		rebuild = true;
+	}
+	if (texture->CompressionNone != decision.noCompression){
+		texture->CompressionNone = decision.noCompression;
+		rebuild = true;
+	}
+	texture->NeverStream = decision.neverStream;
+	return rebuild;
+}
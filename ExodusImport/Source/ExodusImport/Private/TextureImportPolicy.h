@@ -0,0 +1,74 @@
+#pragma once
+#include "JsonTypes.h"
+#include "Engine/Texture.h"
+
+class JsonTexture;
+class JsonMaterial;
+class UTextureFactory;
+
+/*
+Picks unreal texture settings from unity import settings and from how materials use the texture.
+
+Material usage takes priority over texture names. Textures bound to instances of the shipped base materials feed color samplers,
+so apart from normal maps they are made srgb with default compression, and data maps only get the specular texture group.
+Data maps used only by generated material graphs, which take sampler types from the texture, are imported as linear masks.
+Normal maps are recognized by unity texture type, material slots, and finally by name suffix. Sprites and GUI textures get no mips and never stream.
+Max size follows unity max texture size, limited by maxTextureSize.
+*/
+class TextureImportPolicy{
+public:
+	enum UsageFlags: uint32{
+		UsageColor = 1 << 0,
+		UsageNormal = 1 << 1,
+		UsageMask = 1 << 2,
+		UsageGrayscale = 1 << 3,
+		UsageEmission = 1 << 4,
+		//Bound to a texture parameter of a shipped base material.
+		UsageBaseMaterial = 1 << 5
+	};
+
+	struct Settings{
+		bool enabled = true;
+		//0 means no limit
+		int32 maxTextureSize = 4096;
+		bool useUnityMaxTextureSize = true;
+	};
+
+	struct Decision{
+		bool normalMap = false;
+		bool srgb = true;
+		bool noMipmaps = false;
+		bool neverStream = false;
+		bool noCompression = false;
+		int32 maxTextureSize = 0;
+		TextureCompressionSettings compression = TC_Default;
+		TextureGroup lodGroup = TEXTUREGROUP_World;
+		const TCHAR* reason = TEXT("default");
+	};
+protected:
+	Settings settings;
+	TMap<JsonId, uint32> textureUsage;
+	static bool isLegacyNormalMapName(const FString &name);
+public:
+	void setSettings(const Settings &newSettings){
+		settings = newSettings;
+	}
+	const Settings& getSettings() const{
+		return settings;
+	}
+
+	void clearUsage(){
+		textureUsage.Empty();
+	}
+	void gatherUsage(const JsonMaterial &jsonMat, bool baseMaterialInstance);
+	uint32 getUsage(JsonId texId) const{
+		auto found = textureUsage.Find(texId);
+		return found ? *found: 0;
+	}
+
+	Decision decide(const JsonTexture &jsonTex) const;
+	//Settings known before the texture exists are passed to the factory, so the texture is compressed once.
+	static void applyToFactory(UTextureFactory *factory, const Decision &decision);
+	//Returns true if the texture has to be rebuilt.
+	static bool applyToTexture(UTexture *texture, const Decision &decision);
+};
@@ -450,7 +450,7 @@ void UnrealUtilities::setObjectHierarchy(const ImportedObject &object, ImportedO
 	}
 	else{
 		if (folderPath.Len())
-			object.setFolderPath(*folderPath);
+			workData.setFolderPath(object, folderPath);
 	}
 
 	if (setActiveFlag)
@@ -75,7 +75,7 @@ namespace UnrealUtilities{
 	}
 
 	template<typename Res> Res* loadResourceById(
-			const IdNameMap &idMap, int32 id, 
+			const IdPathMap &idMap, int32 id, 
 			std::function<Res*(const FString &path)> loader, 
 			const FString& resType = TEXT("Unspecified")){
 		check(loader);
@@ -89,14 +89,14 @@ namespace UnrealUtilities{
 			UE_LOG(JsonLog, Log, TEXT("Id %d is not in the map"), id);
 			return 0;
 		}
-		auto resPath = *foundPath;
+		auto resPath = foundPath->ToString();
 		Res* result = loader(resPath);
 		UE_LOG(JsonLog, Log, TEXT("Resource type located: %s"), *resType);
 		return result;
 	}
 
 	template<typename Res> Res* staticLoadResourceById(
-			const IdNameMap &idMap, int32 id, const FString& resType = TEXT("Unspecified")){
+			const IdPathMap &idMap, int32 id, const FString& resType = TEXT("Unspecified")){
 		return loadResourceById<Res>(idMap, id, 
 			[](const FString &path) -> auto{
 				return Cast<Res>(StaticLoadObject(Res::StaticClass(), 0, *path));
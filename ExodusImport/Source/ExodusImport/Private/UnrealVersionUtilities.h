@@ -11,6 +11,9 @@
 #if ((ENGINE_MAJOR_VERSION >= 4) && (ENGINE_MINOR_VERSION >= 22))
 	#define EXODUS_UE_VER_4_22_GE
 #endif
+#if ((ENGINE_MAJOR_VERSION >= 4) && (ENGINE_MINOR_VERSION >= 25))
+	#define EXODUS_UE_VER_4_25_GE
+#endif
 #if ((ENGINE_MAJOR_VERSION >= 4) && (ENGINE_MINOR_VERSION >= 26))
 	#define EXODUS_UE_VER_4_26_GE
 #endif
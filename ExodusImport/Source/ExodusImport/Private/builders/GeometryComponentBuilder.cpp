@@ -111,7 +111,7 @@ ImportedObject GeometryComponentBuilder::processMeshAndColliders(ImportContext&
 		if (!createdRootActor){
 			createdRootActor = workData.world->SpawnActor<AActor>(AActor::StaticClass(), jsonGameObj.getUnrealTransform());
 			createdRootActor->SetActorLabel(jsonGameObj.ueName);
-			createdRootActor->SetFolderPath(*folderPath);
+			workData.setFolderPath(ImportedObject(createdRootActor), folderPath);
 			check(createdRootActor);
 		}
 		return createdRootActor;
@@ -510,13 +510,12 @@ bool GeometryComponentBuilder::configureStaticMeshComponent(ImportContext &workD
 	auto foundMeshPath = importer->findMeshPath(meshId);
 	if (!foundMeshPath){
 		UE_LOG(JsonLog, Error, TEXT("Mesh path not found for id %d"), meshId.id);
+		return false;
 	}
-	UE_LOG(JsonLog, Log, TEXT("Mesh path: %s"), **foundMeshPath);
-	auto meshPath = *foundMeshPath;
 
-	auto *meshObject = LoadObject<UStaticMesh>(0, *meshPath);
+	auto *meshObject = importer->loadStaticMeshById(meshId);
 	if (!meshObject){
-		UE_LOG(JsonLog, Warning, TEXT("Could not load mesh %s"), *meshPath);
+		UE_LOG(JsonLog, Warning, TEXT("Could not load mesh %s"), *foundMeshPath->ToString());
 		return false;
 	}
 
@@ -540,6 +539,8 @@ bool GeometryComponentBuilder::configureStaticMeshComponent(ImportContext &workD
 
 	if (!collisionOnlyMesh && configForRender){
 		configureMeshRendererData(*meshComp, jsonGameObj, *importer, meshId);
+		applyLightmapResolution(*meshComp, jsonGameObj, *importer);
+		applyBakedLightmap(workData, *meshComp, jsonGameObj, *importer);
 		/*
 		const auto &renderer = jsonGameObj.renderers[0];
 		auto materials = jsonGameObj.getFirstMaterials();
@@ -606,3 +607,63 @@ void GeometryComponentBuilder::configureMeshRendererData(UStaticMeshComponent& m
 	if (emissiveMesh)
 		meshComp.LightmassSettings.bUseEmissiveForStaticLighting = true;
 }
+
+/*
+Replaces materials with their baked lightmap variants and stores the renderer's lightmap uv transform in custom primitive data.
+The component is excluded from lightmass surface lightmaps, as its static lighting comes from unity.
+*/
+void GeometryComponentBuilder::applyBakedLightmap(const ImportContext &workData, UStaticMeshComponent& meshComp, 
+		const JsonGameObject& jsonGameObj, JsonImporter& importer){
+	if (!importer.usesBakedLightmaps() || !jsonGameObj.hasRenderers())
+		return;
+	const auto& renderer = jsonGameObj.renderers[0];
+	if (!renderer.hasLightmap() || !jsonGameObj.isStatic)
+		return;
+	//Scenes exported without lightmaps (or by older exporters) have no lightmap table.
+	if (!workData.hasLightmaps())
+		return;
+
+	auto lightmap = workData.findLightmap(renderer.lightmapIndex);
+	if (!lightmap || !lightmap->hasColor()){
+		UE_LOG(JsonLog, Warning, TEXT("Lightmap %d not found for object %d(%s)"), renderer.lightmapIndex, jsonGameObj.id, *jsonGameObj.name);
+		return;
+	}
+
+#ifdef EXODUS_UE_VER_4_26_GE
+	auto materials = jsonGameObj.getFirstMaterials();
+	for (int i = 0; i < materials.Num(); i++){
+		auto material = importer.loadBakedLightmapMaterial(materials[i], lightmap->colorTexId);
+		if (material)
+			meshComp.SetMaterial(i, material);
+	}
+
+	meshComp.SetDefaultCustomPrimitiveDataVector4(0, renderer.getUnrealLightmapScaleOffset());
+	meshComp.LightmapType = ELightmapType::ForceVolumetric;
+#else
+	UE_LOG(JsonLog, Warning, TEXT("Baked lightmaps require custom primitive data (4.26 or later), lightmap on object %d(%s) is ignored"), 
+		jsonGameObj.id, *jsonGameObj.name);
+#endif
+}
+
+/*
+Mesh lightmap resolution is picked for unit scale. Scaled instances override it, so texel density stays the same across the level.
+*/
+void GeometryComponentBuilder::applyLightmapResolution(UStaticMeshComponent& meshComp, const JsonGameObject& jsonGameObj, const JsonImporter& importer){
+	auto mesh = meshComp.GetStaticMesh();
+	if (!mesh)
+		return;
+
+	auto scale = jsonGameObj.getUnrealTransform().GetScale3D().GetAbs();
+	auto avgScale = (scale.X + scale.Y + scale.Z) / 3.0f;
+	if (FMath::IsNearlyEqual(avgScale, 1.0f, 0.25f))
+		return;
+
+	const auto &settings = importer.getLightmapUvSettings();
+	auto resolution = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(FMath::CeilToInt(mesh->LightMapResolution * avgScale), 1));
+	resolution = FMath::Clamp(resolution, settings.minResolution, settings.maxResolution);
+	if (resolution == mesh->LightMapResolution)
+		return;
+
+	meshComp.bOverrideLightMapRes = true;
+	meshComp.OverriddenLightMapRes = resolution;
+}
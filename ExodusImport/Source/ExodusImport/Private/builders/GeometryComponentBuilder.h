@@ -18,6 +18,8 @@ protected:
 		JsonImporter *importer);
 
 	static void configureMeshRendererData(UStaticMeshComponent& meshComp, const JsonGameObject& jsonGameObj, JsonImporter& importer, const ResId &meshId);
+	static void applyLightmapResolution(UStaticMeshComponent& meshComp, const JsonGameObject& jsonGameObj, const JsonImporter& importer);
+	static void applyBakedLightmap(const ImportContext &workData, UStaticMeshComponent& meshComp, const JsonGameObject& jsonGameObj, JsonImporter& importer);
 
 	static void setupCommonColliderSettings(const ImportContext &workData, UPrimitiveComponent *dstCollider, const JsonGameObject &jsonGameObj, const JsonCollider &collider);
 	static bool configureStaticMeshComponent(ImportContext &workData, UStaticMeshComponent *meshComp, 
@@ -1,6 +1,5 @@
 #include "JsonImportPrivatePCH.h"
 #include "JointBuilder.h"
-#include "JsonGameObjectRegistry.h"
 
 #include "UnrealUtilities.h"
 #include "JsonObjects.h"
@@ -318,8 +317,7 @@ FTransform &jointTransform, const JsonPhysicsJoint &joint, const JsonGameObject
 	//physConstraint->SetWorldTransform(hingeTransform);
 }
 
-void JointBuilder::processPhysicsJoint(const JsonGameObject &obj, const InstanceIdMap &instanceMap,
-	const TArray<JsonGameObject>& objects, ImportContext &workData) const{
+void JointBuilder::processPhysicsJoint(const JsonGameObject &obj, const JsonSceneIndex &sceneIndex, ImportContext &workData) const{
 	using namespace UnrealUtilities;
 
 	if (!obj.hasJoints())
@@ -338,7 +336,7 @@ void JointBuilder::processPhysicsJoint(const JsonGameObject &obj, const Instance
 	for (int jointIndex = 0; jointIndex < obj.joints.Num(); jointIndex++){
 		const JsonPhysicsJoint &curJoint = obj.joints[jointIndex];
 
-		auto dstJsonObj = resolveObjectReference(curJoint.connectedBodyObject, instanceMap, objects);
+		auto dstJsonObj = sceneIndex.resolveObjectReference(curJoint.connectedBodyObject);
 		if (!curJoint.isConnectedToWorld() && !dstJsonObj){
 			UE_LOG(JsonLog, Warning, TEXT("dst object %d not found while processing joints on %d(%d: \"%s\")"),
 				curJoint.connectedBodyObject.instanceId, obj.instanceId, obj.id, *obj.name);
@@ -417,44 +415,19 @@ void JointBuilder::processPhysicsJoint(const JsonGameObject &obj, const Instance
 }
 
 void JointBuilder::processPhysicsJoints(const TArray<JsonGameObject>& objects, ImportContext &workData) const{
-	InstanceIdMap instanceMap;
+	const auto &sceneIndex = workData.getSceneIndex();
+	if (!sceneIndex.anyObjectHas(JsonSceneIndex::CompJoints))
+		return;
 	FScopedSlowTask progress(objects.Num(), LOCTEXT("Processing joints", "Processing joints"));
 	progress.MakeDialog();
 	UE_LOG(JsonLog, Log, TEXT("Processing joints"));
 	for (int i = 0; i < objects.Num(); i++){
-		auto srcObj = objects[i];
-		if (srcObj.hasJoints()){
-			if (instanceMap.isEmpty()){
-				buildInstanceIdMap(instanceMap, objects);
-				check(!instanceMap.isEmpty());
-			}
-			processPhysicsJoint(srcObj, instanceMap, objects, workData);
-		}
+		if (sceneIndex.hasComponents(i, JsonSceneIndex::CompJoints))
+			processPhysicsJoint(objects[i], sceneIndex, workData);
 		progress.EnterProgressFrame(1.0f);
 	}
 }
 
-void JointBuilder::buildInstanceIdMap(InstanceIdMap &outMap, const TArray<JsonGameObject>& objects){
-	outMap.clear();
-	for (const auto &cur : objects){
-		auto instId = cur.instanceId;
-		auto objId = cur.id;
-		outMap.registerId(instId, objId);
-	}
-}
-
-const JsonGameObject* JointBuilder::resolveObjectReference(const JsonObjectReference &ref,
-	const InstanceIdMap &instanceMap, const TArray<JsonGameObject>& objects) const{
-	if (ref.isNull)
-		return nullptr;
-	auto found = instanceMap.find(ref.instanceId);
-	if (!found)
-		return nullptr;
-	if ((*found < 0) || (*found >= objects.Num()))
-		return nullptr;
-	return &objects[*found];
-}
-
 bool JointBuilder::getConstraintMotion(EAngularConstraintMotion &angMotion, const FString &arg){
 	angMotion = ACM_Locked;
 	if (arg == "Free"){
@@ -1,6 +1,5 @@
 #pragma once
 #include "JsonTypes.h"
-#include "InstanceIdMap.h"
 #include "ImportContext.h"
 
 class UPhysicsConstraintComponent;
@@ -26,10 +25,7 @@ protected:
 	static EAngularConstraintMotion getAngularMotionChecked(const FString &arg, const FString &motionName, int jointIndex, const JsonGameObject &jsonObj);
 	static ELinearConstraintMotion getLinearMotionChecked(const FString &arg, const FString &motionName, int jointIndex, const JsonGameObject &jsonObj);
 
-	const JsonGameObject* resolveObjectReference(const JsonObjectReference &ref, const InstanceIdMap &instanceMap, const TArray<JsonGameObject>& objects) const;
-	void processPhysicsJoint(const JsonGameObject &obj, const InstanceIdMap &instanceMap,
-		const TArray<JsonGameObject>& objects, ImportContext &workData) const;
-	static void buildInstanceIdMap(InstanceIdMap &outMap, const TArray<JsonGameObject>& objects);
+	void processPhysicsJoint(const JsonGameObject &obj, const JsonSceneIndex &sceneIndex, ImportContext &workData) const;
 
 	const bool isSupportedJoint(const JsonPhysicsJoint &joint) const;
 
@@ -0,0 +1,223 @@
+#include "JsonImportPrivatePCH.h"
+#include "LightAnalysis.h"
+#include "JsonObjects/JsonGameObject.h"
+#include "JsonObjects/JsonLight.h"
+
+float LightAnalysis::computeContribution(const JsonLight &light){
+	auto result = FMath::Max(light.intensity, 0.0f) * light.color.GetLuminance();
+	if (light.isLocal())
+		result *= light.range * light.range;
+	return result;
+}
+
+void LightAnalysis::gatherLights(const TArray<JsonGameObject> &objects){
+	for(const auto &obj: objects){
+		for(int32 lightIndex = 0; lightIndex < obj.lights.Num(); lightIndex++){
+			const auto &jsonLight = obj.lights[lightIndex];
+			LightInfo info;
+			info.objId = obj.id;
+			info.lightIndex = lightIndex;
+			info.name = obj.ueName;
+			info.lightType = jsonLight.lightType;
+			info.position = obj.ueWorldMatrix.GetOrigin();
+			info.radius = FMath::Max(jsonLight.range, 0.0f) * 100.0f;
+			info.contribution = computeContribution(jsonLight);
+			info.important = jsonLight.isImportant();
+			info.local = jsonLight.isLocal();
+			info.sourceShadows = jsonLight.castsShadows;
+			info.castShadows = jsonLight.castsShadows;
+			if (settings.convertBakedLights && !jsonLight.lightmapBakeType.IsEmpty()){
+				if (jsonLight.lightmapBakeType == TEXT("Baked")){
+					info.overrideMobility = true;
+					info.mobility = EComponentMobility::Static;
+				}
+				else if (jsonLight.lightmapBakeType == TEXT("Mixed")){
+					info.overrideMobility = true;
+					info.mobility = EComponentMobility::Stationary;
+				}
+			}
+			if (jsonLight.isNotImportant() && info.castShadows){
+				info.castShadows = false;
+				info.note = TEXT("not important");
+			}
+			//Static lights would add their lighting on top of the imported lightmaps.
+			if (unityLightmapsApplied && (jsonLight.lightmapBakeType == TEXT("Baked"))){
+				info.skipped = true;
+				info.castShadows = false;
+				info.overrideMobility = false;
+				info.note = TEXT("in unity lightmaps, not created");
+			}
+			lightIndices.Add(TPair<JsonId, int32>(obj.id, lightIndex), lights.Add(info));
+		}
+	}
+}
+
+/*
+Sweep along x. Lights are sorted by the start of their bounds, so the inner loop stops at the first light that starts past the current one.
+*/
+void LightAnalysis::computeOverlaps(){
+	TArray<int32> sorted;
+	for(int32 i = 0; i < lights.Num(); i++){
+		if (lights[i].local && !lights[i].skipped)
+			sorted.Add(i);
+	}
+	sorted.Sort([&](int32 a, int32 b){
+		return (lights[a].position.X - lights[a].radius) < (lights[b].position.X - lights[b].radius);
+	});
+
+	TArray<TPair<int32, int32>> pairs;
+	for(int32 i = 0; i < sorted.Num(); i++){
+		const auto &a = lights[sorted[i]];
+		auto maxX = a.position.X + a.radius;
+		for(int32 j = i + 1; j < sorted.Num(); j++){
+			const auto &b = lights[sorted[j]];
+			if ((b.position.X - b.radius) > maxX)
+				break;
+			auto dist = a.radius + b.radius;
+			if (FVector::DistSquared(a.position, b.position) < dist * dist)
+				pairs.Add(TPair<int32, int32>(sorted[i], sorted[j]));
+		}
+	}
+
+	overlapOffsets.Init(0, lights.Num() + 1);
+	for(const auto &cur: pairs){
+		overlapOffsets[cur.Key + 1]++;
+		overlapOffsets[cur.Value + 1]++;
+	}
+	for(int32 i = 0; i < lights.Num(); i++)
+		overlapOffsets[i + 1] += overlapOffsets[i];
+	overlapIds.SetNumUninitialized(overlapOffsets.Last());
+	TArray<int32> fill(overlapOffsets.GetData(), lights.Num());
+	for(const auto &cur: pairs){
+		overlapIds[fill[cur.Key]++] = cur.Value;
+		overlapIds[fill[cur.Value]++] = cur.Key;
+	}
+
+	for(int32 i = 0; i < lights.Num(); i++){
+		auto &info = lights[i];
+		auto overlaps = getOverlaps(i);
+		info.overlapCount = overlaps.Num();
+		for(auto other: overlaps){
+			if (lights[other].sourceShadows)
+				info.shadowedOverlapCount++;
+		}
+		info.excessiveOverlap = info.sourceShadows && (info.shadowedOverlapCount >= settings.maxShadowedOverlap);
+	}
+}
+
+void LightAnalysis::budgetShadows(){
+	auto isBudgeted = [&](const LightInfo &info){
+		return info.local && info.castShadows && !info.skipped
+			&& !(info.overrideMobility && (info.mobility == EComponentMobility::Static));
+	};
+
+	TArray<int32> order;
+	for(int32 i = 0; i < lights.Num(); i++){
+		if (isBudgeted(lights[i]))
+			order.Add(i);
+	}
+	order.Sort([&](int32 a, int32 b){
+		const auto &infoA = lights[a];
+		const auto &infoB = lights[b];
+		if (infoA.important != infoB.important)
+			return infoA.important;
+		return infoA.contribution > infoB.contribution;
+	});
+
+	TBitArray<> kept(false, lights.Num());
+	for(auto index: order){
+		auto &info = lights[index];
+		int32 keptOverlaps = 0;
+		float strongestNeighbour = 0.0f;
+		for(auto other: getOverlaps(index)){
+			if (!kept[other])
+				continue;
+			keptOverlaps++;
+			strongestNeighbour = FMath::Max(strongestNeighbour, lights[other].contribution);
+		}
+
+		if (keptOverlaps >= settings.maxShadowedOverlap){
+			info.castShadows = false;
+			info.note = FString::Printf(TEXT("over budget, %d shadowed lights overlap"), keptOverlaps);
+			continue;
+		}
+		if (!info.important && (info.contribution < strongestNeighbour * settings.minRelativeShadowContribution)){
+			info.castShadows = false;
+			info.note = TEXT("low contribution");
+			continue;
+		}
+		kept[index] = true;
+	}
+}
+
+void LightAnalysis::build(const TArray<JsonGameObject> &objects, const Settings &newSettings, bool unityLightmapsApplied_){
+	settings = newSettings;
+	unityLightmapsApplied = unityLightmapsApplied_;
+	lights.Reset();
+	lightIndices.Reset();
+	overlapOffsets.Reset();
+	overlapIds.Reset();
+
+	gatherLights(objects);
+	computeOverlaps();
+	if (settings.budgetShadows)
+		budgetShadows();
+}
+
+const LightAnalysis::LightInfo* LightAnalysis::find(JsonId objId, int32 lightIndex) const{
+	auto found = lightIndices.Find(TPair<JsonId, int32>(objId, lightIndex));
+	if (!found)
+		return nullptr;
+	return &lights[*found];
+}
+
+FString LightAnalysis::makeReport() const{
+	auto mobilityName = [](const LightInfo &info) -> const TCHAR*{
+		if (info.skipped)
+			return TEXT("skipped");
+		if (!info.overrideMobility)
+			return TEXT("-");
+		switch(info.mobility){
+			case EComponentMobility::Static:
+				return TEXT("static");
+			case EComponentMobility::Stationary:
+				return TEXT("stationary");
+			default:
+				return TEXT("movable");
+		}
+	};
+
+	int32 numShadowed = 0, numSourceShadowed = 0, numExcessive = 0, numStatic = 0, numSkipped = 0;
+	for(const auto &cur: lights){
+		if (cur.castShadows)
+			numShadowed++;
+		if (cur.sourceShadows)
+			numSourceShadowed++;
+		if (cur.excessiveOverlap)
+			numExcessive++;
+		if (cur.overrideMobility && (cur.mobility == EComponentMobility::Static))
+			numStatic++;
+		if (cur.skipped)
+			numSkipped++;
+	}
+
+	FString result = FString::Printf(
+		TEXT("Lights: %d; shadowed: %d (%d in source); excessive shadowed overlap: %d; converted to static: %d; skipped: %d\n")
+		TEXT("Max shadowed overlap: %d\n")
+		TEXT("Unity lightmaps applied: %s\n\n")
+		TEXT("id\tlight\tname\ttype\tradius\tcontribution\toverlaps\tshadowed overlaps\tshadows\tmobility\tnote\n"),
+		lights.Num(), numShadowed, numSourceShadowed, numExcessive, numStatic, numSkipped, settings.maxShadowedOverlap,
+		unityLightmapsApplied ? TEXT("yes, baked lights are skipped"): 
+			(settings.convertBakedLights ? TEXT("no, baked lights become static"): TEXT("no"))
+	);
+
+	for(const auto &cur: lights){
+		result += FString::Printf(TEXT("%d\t%d\t%s\t%s\t%.1f\t%.3f\t%d\t%d%s\t%s\t%s\t%s\n"),
+			cur.objId, cur.lightIndex, *cur.name, *cur.lightType, cur.radius, cur.contribution,
+			cur.overlapCount, cur.shadowedOverlapCount, cur.excessiveOverlap ? TEXT("!"): TEXT(""),
+			cur.castShadows ? TEXT("on"): (cur.sourceShadows ? TEXT("disabled"): TEXT("off")),
+			mobilityName(cur), *cur.note
+		);
+	}
+	return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "JsonTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Containers/ArrayView.h"
+
+class JsonGameObject;
+class JsonLight;
+
+/*
+Scene wide light analysis, done once before lights are created.
+
+Local lights are treated as spheres of their range. For every light it records how many other lights reach into it,
+then decides which lights keep shadows: lights are visited by priority (important ones first, then by contribution),
+and a light keeps shadows only while fewer than maxShadowedOverlap shadowed lights already overlap it.
+Lights much weaker than their strongest shadowed neighbour, and "not important" lights, lose shadows as well.
+
+With convertBakedLights, unity light bake type picks mobility: Baked lights become static and Mixed become stationary.
+Static lights cost nothing at runtime, so they are not budgeted.
+When unity lightmaps are applied to the scene, Baked lights are skipped instead, as their lighting is already in the lightmaps.
+*/
+class LightAnalysis{
+public:
+	struct Settings{
+		bool enabled = true;
+		bool convertBakedLights = true;
+		bool budgetShadows = true;
+		//Unreal can only give shadowmap channels to 4 overlapping stationary lights.
+		int32 maxShadowedOverlap = 4;
+		float minRelativeShadowContribution = 0.1f;
+	};
+
+	struct LightInfo{
+		JsonId objId = -1;
+		int32 lightIndex = -1;
+		FString name;
+		FString lightType;
+		FVector position = FVector::ZeroVector;
+		float radius = 0.0f;
+		float contribution = 0.0f;
+		bool important = false;
+		bool local = false;
+
+		bool sourceShadows = false;
+		bool castShadows = false;
+		int32 overlapCount = 0;
+		int32 shadowedOverlapCount = 0;
+		bool excessiveOverlap = false;
+
+		bool overrideMobility = false;
+		EComponentMobility::Type mobility = EComponentMobility::Movable;
+		//Not created at all.
+		bool skipped = false;
+		FString note;
+	};
+protected:
+	Settings settings;
+	bool unityLightmapsApplied = false;
+	TArray<LightInfo> lights;
+	TMap<TPair<JsonId, int32>, int32> lightIndices;
+	TArray<int32> overlapOffsets;
+	TArray<int32> overlapIds;
+
+	static float computeContribution(const JsonLight &light);
+	void gatherLights(const TArray<JsonGameObject> &objects);
+	void computeOverlaps();
+	void budgetShadows();
+
+	TArrayView<const int32> getOverlaps(int32 index) const{
+		return TArrayView<const int32>(overlapIds.GetData() + overlapOffsets[index], overlapOffsets[index + 1] - overlapOffsets[index]);
+	}
+public:
+	void build(const TArray<JsonGameObject> &objects, const Settings &newSettings, bool unityLightmapsApplied_);
+	const LightInfo* find(JsonId objId, int32 lightIndex) const;
+	const TArray<LightInfo>& getLights() const{
+		return lights;
+	}
+	bool isEmpty() const{
+		return lights.Num() == 0;
+	}
+
+	FString makeReport() const;
+};
@@ -7,6 +7,7 @@
 #include "Engine/Classes/Components/SpotLightComponent.h"
 #include "Engine/Classes/Components/DirectionalLightComponent.h"
 #include "UnrealUtilities.h"
+#include "LightAnalysis.h"
 #include <utility>
 
 void LightBuilder::setupPointLightComponent(UPointLightComponent *pointLight, const JsonLight &jsonLight){
@@ -76,11 +77,42 @@ std::pair<ActorClass*, ComponentClass*> createLightActorAndComponent(
 	return std::make_pair(lightActor, lightComponent);
 }
 
-ImportedObject LightBuilder::processLight(ImportContext &workData, const JsonGameObject &gameObj, const JsonLight &jsonLight, ImportedObject *parentObject,
+/*
+Applies mobility and shadow decisions of the scene light analysis. Without analysis static objects produce static lights.
+*/
+void LightBuilder::applyLightAnalysis(ImportContext &workData, const JsonGameObject &gameObj, int32 lightIndex, ALight *lightActor, USceneComponent *lightComponent){
+	const LightAnalysis::LightInfo *info = workData.lightAnalysis ? workData.lightAnalysis->find(gameObj.id, lightIndex): nullptr;
+
+	bool setMobility = gameObj.isStatic;
+	auto mobility = EComponentMobility::Static;
+	if (info && info->overrideMobility){
+		setMobility = true;
+		mobility = info->mobility;
+	}
+	if (setMobility){
+		if (lightActor)
+			lightActor->SetMobility(mobility);
+		else if (lightComponent)
+			lightComponent->SetMobility(mobility);
+	}
+
+	if (!info)
+		return;
+	auto light = lightActor ? lightActor->GetLightComponent(): Cast<ULightComponent>(lightComponent);
+	if (light)
+		light->SetCastShadows(info->castShadows);
+}
+
+ImportedObject LightBuilder::processLight(ImportContext &workData, const JsonGameObject &gameObj, const JsonLight &jsonLight, int32 lightIndex, ImportedObject *parentObject,
 		const FString& folderPath, bool createActors, std::function<UObject*()> outerCreator){
 	using namespace UnrealUtilities;
 
 	UE_LOG(JsonLog, Log, TEXT("Creating light"));
+	auto analysisInfo = workData.lightAnalysis ? workData.lightAnalysis->find(gameObj.id, lightIndex): nullptr;
+	if (analysisInfo && analysisInfo->skipped){
+		UE_LOG(JsonLog, Log, TEXT("Light %d on object %d(%s) is skipped: %s"), lightIndex, gameObj.id, *gameObj.scenePath, *analysisInfo->note);
+		return ImportedObject();
+	}
 
 	FTransform lightTransform;
 	lightTransform.SetFromMatrix(gameObj.ueWorldMatrix);
@@ -129,14 +161,12 @@ ImportedObject LightBuilder::processLight(ImportContext &workData, const JsonGam
 
 	if (lightActor){
 		lightActor->SetActorLabel(gameObj.ueName, true);
-		if (gameObj.isStatic)
-			lightActor->SetMobility(EComponentMobility::Static);
+		applyLightAnalysis(workData, gameObj, lightIndex, lightActor, lightComponent);
 		setObjectHierarchy(ImportedObject(lightActor), parentObject, folderPath, workData, gameObj);
 		lightActor->MarkComponentsRenderStateDirty();
 	}
 	else if (lightComponent){
-		if (gameObj.isStatic)
-			lightComponent->SetMobility(EComponentMobility::Static);
+		applyLightAnalysis(workData, gameObj, lightIndex, lightActor, lightComponent);
 		auto compName = FString::Printf(TEXT("%s_light(%d_%llu)"), *gameObj.ueName, gameObj.id, workData.getUniqueUint());
 		lightComponent->Rename(*compName);
 	}
@@ -157,7 +187,7 @@ void LightBuilder::processLights(ImportContext &workData, const JsonGameObject &
 	for(int i = 0; i < gameObj.lights.Num(); i++){
 		const auto &curLight = gameObj.lights[i];
 		//processLight(workData, gameObj, curLight, parentActor, folderPath);
-		auto light = processLight(workData, gameObj, curLight, parentObject, folderPath, createActors, outerCreator);
+		auto light = processLight(workData, gameObj, curLight, i, parentObject, folderPath, createActors, outerCreator);
 		registerImportedObject(createdObjects, light);
 	}
 }
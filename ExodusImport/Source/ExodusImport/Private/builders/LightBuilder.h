@@ -8,6 +8,7 @@ class UPointLightComponent;
 class USpotLightComponent;
 class ULightComponent;
 class USceneComponent;
+class ALight;
 
 class LightBuilder{
 public:
@@ -15,7 +16,8 @@ public:
 	static void setupSpotLightComponent(USpotLightComponent *spotLight, const JsonLight &jsonLight);
 	static void setupDirLightComponent(ULightComponent *dirLight, const JsonLight &jsonLight);
 
-	static ImportedObject processLight(ImportContext &workData, const JsonGameObject &gameObj, const JsonLight &light,
+	static void applyLightAnalysis(ImportContext &workData, const JsonGameObject &gameObj, int32 lightIndex, ALight *lightActor, USceneComponent *lightComponent);
+	static ImportedObject processLight(ImportContext &workData, const JsonGameObject &gameObj, const JsonLight &light, int32 lightIndex,
 		ImportedObject *parentObject, const FString& folderPath, bool createActors, std::function<UObject*()> outerCreator);
 	static void processLights(ImportContext &workData, const JsonGameObject &gameObj, ImportedObject *parentObject, const FString& folderPath,
 		ImportedObjectArray *createdObjects, bool createActors, std::function<UObject*()> outerCreator);
@@ -8,6 +8,183 @@
 #include "UnrealUtilities.h"
 #include "JsonObjects/loggers.h"
 #include "JsonImporter.h"
+#include "HAL/IConsoleManager.h"
+
+float ReflectionCapturePlan::getSphereOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller){
+	auto r1 = larger.radius;
+	auto r2 = smaller.radius;
+	if (r2 <= 0.0f)
+		return 1.0f;
+	auto d = FVector::Dist(larger.center, smaller.center);
+	if (d + r2 <= r1)
+		return 1.0f;
+	if (d >= r1 + r2)
+		return 0.0f;
+	if (d + r1 <= r2)
+		return FMath::Pow(r1 / r2, 3.0f);
+
+	//Sphere-sphere intersection (lens) volume, relative to the smaller sphere.
+	auto lens = PI * FMath::Square(r1 + r2 - d) * (d * d + 2.0f * d * r2 - 3.0f * r2 * r2 + 2.0f * d * r1 + 6.0f * r1 * r2 - 3.0f * r1 * r1) / (12.0f * d);
+	auto smallVolume = 4.0f / 3.0f * PI * r2 * r2 * r2;
+	return FMath::Clamp(lens / smallVolume, 0.0f, 1.0f);
+}
+
+float ReflectionCapturePlan::getBoxOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller){
+	auto smallVolume = 8.0f * smaller.halfExtents.X * smaller.halfExtents.Y * smaller.halfExtents.Z;
+	if (smallVolume <= 0.0f)
+		return 1.0f;
+	auto minA = larger.center - larger.halfExtents, maxA = larger.center + larger.halfExtents;
+	auto minB = smaller.center - smaller.halfExtents, maxB = smaller.center + smaller.halfExtents;
+	float overlapVolume = 1.0f;
+	for(int32 i = 0; i < 3; i++)
+		overlapVolume *= FMath::Max(FMath::Min(maxA[i], maxB[i]) - FMath::Max(minA[i], minB[i]), 0.0f);
+	return FMath::Clamp(overlapVolume / smallVolume, 0.0f, 1.0f);
+}
+
+float ReflectionCapturePlan::getOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller){
+	if (larger.box || smaller.box)
+		return getBoxOverlapFraction(larger, smaller);
+	return getSphereOverlapFraction(larger, smaller);
+}
+
+/*
+Merged probes produce no capture, so the area is covered by the cubemap of the probe they merge into.
+*/
+bool ReflectionCapturePlan::isCompatibleSource(const ProbeInfo &kept, const ProbeInfo &merged){
+	if (kept.capturesScene != merged.capturesScene)
+		return false;
+	if (kept.capturesScene || (kept.sourceCubemapId == merged.sourceCubemapId))
+		return true;
+	return kept.baked && merged.baked;
+}
+
+void ReflectionCapturePlan::build(const TArray<JsonGameObject> &objects, const Settings &newSettings){
+	settings = newSettings;
+	probes.Reset();
+	probeIndices.Reset();
+	captureResolution = 0;
+
+	for(const auto &obj: objects){
+		for(int32 probeIndex = 0; probeIndex < obj.probes.Num(); probeIndex++){
+			const auto &probe = obj.probes[probeIndex];
+			ProbeInfo info;
+			info.objId = obj.id;
+			info.probeIndex = probeIndex;
+			ReflectionProbeBuilder::getProbeInfluence(obj, probe, info.center, info.radius, info.halfExtents);
+			info.box = probe.boxProjection;
+			info.volume = info.box ? 
+				8.0f * info.halfExtents.X * info.halfExtents.Y * info.halfExtents.Z:
+				4.0f / 3.0f * PI * info.radius * info.radius * info.radius;
+			info.resolution = probe.resolution;
+			if (probe.isCustom())
+				info.sourceCubemapId = probe.customCubemapId;
+			else if (probe.isBaked() && settings.reuseBakedCubemaps)
+				info.sourceCubemapId = probe.bakedCubemapId;
+			info.capturesScene = info.sourceCubemapId < 0;
+			info.baked = !info.capturesScene && !probe.isCustom();
+			probeIndices.Add(TPair<JsonId, int32>(obj.id, probeIndex), probes.Add(info));
+		}
+	}
+
+	TArray<int32> order;
+	for(int32 i = 0; i < probes.Num(); i++)
+		order.Add(i);
+	order.Sort([&](int32 a, int32 b){
+		return probes[a].volume > probes[b].volume;
+	});
+
+	TArray<int32> keptOrder;
+	for(auto index: order){
+		auto &info = probes[index];
+		for(auto keptIndex: keptOrder){
+			const auto &kept = probes[keptIndex];
+			if (!isCompatibleSource(kept, info))
+				continue;
+			if (getOverlapFraction(kept, info) >= settings.mergeOverlap){
+				info.kept = false;
+				info.mergedInto = keptIndex;
+				break;
+			}
+		}
+		if (info.kept)
+			keptOrder.Add(index);
+	}
+
+	if ((settings.maxCaptures > 0) && (keptOrder.Num() > settings.maxCaptures)){
+		for(int32 i = settings.maxCaptures; i < keptOrder.Num(); i++)
+			probes[keptOrder[i]].kept = false;
+		keptOrder.SetNum(settings.maxCaptures);
+	}
+
+	for(auto index: keptOrder){
+		if (probes[index].capturesScene)
+			captureResolution = FMath::Max(captureResolution, probes[index].resolution);
+	}
+}
+
+const ReflectionCapturePlan::ProbeInfo* ReflectionCapturePlan::find(JsonId objId, int32 probeIndex) const{
+	auto found = probeIndices.Find(TPair<JsonId, int32>(objId, probeIndex));
+	if (!found)
+		return nullptr;
+	return &probes[*found];
+}
+
+bool ReflectionCapturePlan::shouldCreateCapture(JsonId objId, int32 probeIndex) const{
+	auto info = find(objId, probeIndex);
+	return !info || info->kept;
+}
+
+void ReflectionCapturePlan::logSummary() const{
+	int32 numKept = 0, numMerged = 0, numDropped = 0, numReused = 0, numBakedMerged = 0;
+	for(const auto &cur: probes){
+		if (cur.kept){
+			numKept++;
+			if (!cur.capturesScene)
+				numReused++;
+		}
+		else if (cur.mergedInto >= 0){
+			numMerged++;
+			if (cur.baked && (probes[cur.mergedInto].sourceCubemapId != cur.sourceCubemapId))
+				numBakedMerged++;
+		}
+		else
+			numDropped++;
+	}
+	UE_LOG(JsonLog, Log, TEXT("Reflection probes: %d; captures: %d (%d use existing cubemaps); merged: %d (%d baked probes use the cubemap of another probe); dropped over limit: %d"),
+		probes.Num(), numKept, numReused, numMerged, numBakedMerged, numDropped);
+	if (numDropped > 0){
+		UE_LOG(JsonLog, Warning, TEXT("%d reflection probes were dropped, capture limit is %d"), numDropped, settings.maxCaptures);
+	}
+
+	auto resolutionVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.ReflectionCaptureResolution"));
+	if (resolutionVar && (captureResolution > resolutionVar->GetInt())){
+		UE_LOG(JsonLog, Warning, TEXT("Unity reflection probes use resolution up to %d, while r.ReflectionCaptureResolution is %d"),
+			captureResolution, resolutionVar->GetInt());
+	}
+}
+
+/*
+outRadius circumscribes the influence volume. outHalfExtents are the world aligned half extents of its bounding box.
+*/
+void ReflectionProbeBuilder::getProbeInfluence(const JsonGameObject &gameObj, const JsonReflectionProbe &probe, FVector &outCenter, float &outRadius, FVector &outHalfExtents){
+	using namespace UnrealUtilities;
+	FVector ueCenter = unityPosToUe(probe.center);
+	FVector ueSize = unitySizeToUe(probe.size);
+	FVector xAxis, yAxis, zAxis;
+	gameObj.ueWorldMatrix.GetScaledAxes(xAxis, yAxis, zAxis);
+	outCenter = gameObj.ueWorldMatrix.GetOrigin() + xAxis * ueCenter.X + yAxis * ueCenter.Y + zAxis * ueCenter.Z;
+
+	if (!probe.boxProjection){
+		outRadius = FMath::Max3(ueSize.X, ueSize.Y, ueSize.Z) * 0.5f;
+		outHalfExtents = FVector(outRadius);
+		return;
+	}
+	auto halfX = xAxis * ueSize.X * 0.5f;
+	auto halfY = yAxis * ueSize.Y * 0.5f;
+	auto halfZ = zAxis * ueSize.Z * 0.5f;
+	outHalfExtents = halfX.GetAbs() + halfY.GetAbs() + halfZ.GetAbs();
+	outRadius = FVector(halfX.Size(), halfY.Size(), halfZ.Size()).Size();
+}
 
 //void setupReflectionCapture(UReflectionCaptureComponent *reflComponent, const JsonReflectionProbe &probe);
 ImportedObject ReflectionProbeBuilder::processReflectionProbe(ImportContext &workData, const JsonGameObject &gameObj,
@@ -68,6 +245,17 @@ ImportedObject ReflectionProbeBuilder::processReflectionProbe(ImportContext &wor
 			return;
 		reflComponent->Brightness = probe.intensity;
 		reflComponent->ReflectionSourceType = EReflectionSourceType::CapturedScene;
+		if (probe.isBaked() && (probe.bakedCubemapId >= 0) && importer->getReflectionCaptureSettings().reuseBakedCubemaps){
+			auto cube = importer->getCubemap(probe.bakedCubemapId);
+			if (cube){
+				reflComponent->ReflectionSourceType = EReflectionSourceType::SpecifiedCubemap;
+				reflComponent->Cubemap = cube;
+			}
+			else{
+				UE_LOG(JsonLog, Warning, TEXT("Baked cubemap %d not found for reflection probe on object \"%s\"(%d), the scene will be captured instead"),
+					probe.bakedCubemapId, *gameObj.ueName, gameObj.id);
+			}
+		}
 		if (probe.mode == "Custom"){
 			reflComponent->ReflectionSourceType = EReflectionSourceType::SpecifiedCubemap;
 			auto cube = importer->getCubemap(probe.customCubemapId);
@@ -134,6 +322,10 @@ void ReflectionProbeBuilder::processReflectionProbes(ImportContext &workData, co
 
 	for (int i = 0; i < gameObj.probes.Num(); i++){
 		const auto &probe = gameObj.probes[i];
+		if (workData.reflectionCapturePlan && !workData.reflectionCapturePlan->shouldCreateCapture(gameObj.id, i)){
+			UE_LOG(JsonLog, Log, TEXT("Reflection probe %d on object %s(%d) was consolidated, capture is not created"), i, *gameObj.ueName, gameObj.id);
+			continue;
+		}
 		auto probeObject = processReflectionProbe(workData, gameObj, gameObj.probes[i], parentObject, folderPath, importer, outerCallback);
 		registerImportedObject(createdObjects, probeObject);
 	}
@@ -7,8 +7,73 @@
 
 class JsonImporter;
 
+/*
+Decides which unity probes become reflection captures. Done once for the scene before objects are created.
+
+Probes are visited from the largest influence volume down. A probe whose influence volume lies mostly (mergeOverlap or more of it) 
+inside an already kept probe with a compatible reflection source is merged into it and produces no capture.
+Scene capturing probes merge with each other, baked probes merge into a kept baked probe and use its cubemap,
+custom probes only merge when they use the same cubemap.
+Two sphere probes are compared as spheres. When a box probe is involved, both influence volumes are compared as world aligned boxes.
+If more than maxCaptures remain, the smallest ones are dropped.
+*/
+class ReflectionCapturePlan{
+public:
+	struct Settings{
+		bool enabled = true;
+		float mergeOverlap = 0.75f;
+		//0 means no limit.
+		int32 maxCaptures = 64;
+		//Baked probes use the cubemap unity baked for them instead of recapturing the scene.
+		bool reuseBakedCubemaps = true;
+	};
+
+	struct ProbeInfo{
+		JsonId objId = -1;
+		int32 probeIndex = -1;
+		FVector center = FVector::ZeroVector;
+		float radius = 0.0f;
+		//World aligned half extents of the influence volume, sphere probes use their bounding box.
+		FVector halfExtents = FVector::ZeroVector;
+		float volume = 0.0f;
+		bool box = false;
+		int32 resolution = 0;
+		int32 sourceCubemapId = -1;
+		bool capturesScene = true;
+		bool baked = false;
+		bool kept = true;
+		int32 mergedInto = -1;
+	};
+protected:
+	Settings settings;
+	TArray<ProbeInfo> probes;
+	TMap<TPair<JsonId, int32>, int32> probeIndices;
+	int32 captureResolution = 0;
+
+	static float getSphereOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller);
+	static float getBoxOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller);
+	static float getOverlapFraction(const ProbeInfo &larger, const ProbeInfo &smaller);
+	static bool isCompatibleSource(const ProbeInfo &kept, const ProbeInfo &merged);
+public:
+	void build(const TArray<JsonGameObject> &objects, const Settings &newSettings);
+	const ProbeInfo* find(JsonId objId, int32 probeIndex) const;
+	bool shouldCreateCapture(JsonId objId, int32 probeIndex) const;
+	bool isEmpty() const{
+		return probes.Num() == 0;
+	}
+	//Highest resolution among kept captures that capture the scene.
+	int32 getCaptureResolution() const{
+		return captureResolution;
+	}
+	const Settings& getSettings() const{
+		return settings;
+	}
+	void logSummary() const;
+};
+
 class ReflectionProbeBuilder{
 public:
+	static void getProbeInfluence(const JsonGameObject &gameObj, const JsonReflectionProbe &probe, FVector &outCenter, float &outRadius, FVector &outHalfExtents);
 	static ImportedObject processReflectionProbe(ImportContext &workData, const JsonGameObject &gameObj,
 		const JsonReflectionProbe &probe, ImportedObject *parentObject, const FString &folderPath, JsonImporter *importer, std::function<UObject*()> outerCallback);
 	static void processReflectionProbes(ImportContext &workData, const JsonGameObject &gameObj, ImportedObject *parentObject, const FString &folderPath,
@@ -4,6 +4,7 @@
 #include "TerrainBuilder.h"
 #include "JsonImporter.h"
 #include "Landscape.h"
+#include "LandscapeStreamingProxy.h"
 
 void TerrainComponentBuilder::processTerrains(ImportContext &workData, const JsonGameObject &gameObj, ImportedObject *parentObject, 
 		const FString& folderPath, ImportedObjectArray *createdObjects, JsonImporter *importer, std::function<UObject*()> outerCreator){
@@ -48,5 +49,16 @@ ImportedObject TerrainComponentBuilder::processTerrain(ImportContext &workData,
 	ImportedObject result(builtTerrain);
 	setObjectHierarchy(result, parentObject, folderPath, workData, jsonGameObj);
 
+	//Tiles of large terrains live in streaming proxies, they follow the landscape in the outliner.
+	for(auto curProxy: terrainBuilder.streamingProxies){
+		curProxy->PostEditChange();
+		ImportedObject proxyObject(curProxy);
+		setObjectHierarchy(proxyObject, parentObject, folderPath, workData, jsonGameObj);
+	}
+	for(auto curActor: terrainBuilder.detailActors){
+		ImportedObject detailObject(curActor);
+		setObjectHierarchy(detailObject, parentObject, folderPath, workData, jsonGameObj);
+	}
+
 	return result;
 }